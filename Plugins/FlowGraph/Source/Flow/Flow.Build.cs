@@ -10,7 +10,8 @@ public class Flow : ModuleRules
 
 		PublicDependencyModuleNames.AddRange(new[]
 		{
-			"LevelSequence"
+			"LevelSequence",
+			"NetCore"
 		});
 
 		PrivateDependencyModuleNames.AddRange(new[]
@@ -22,7 +23,6 @@ public class Flow : ModuleRules
 			"GameplayTags",
 			"MovieScene",
 			"MovieSceneTracks",
-			"NetCore",
 			"Slate",
 			"SlateCore"
 		});
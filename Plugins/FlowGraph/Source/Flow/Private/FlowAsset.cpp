@@ -3,6 +3,7 @@
 #include "FlowAsset.h"
 
 #include "FlowLogChannels.h"
+#include "FlowProfiler.h"
 #include "FlowSettings.h"
 #include "FlowSubsystem.h"
 
@@ -14,8 +15,6 @@
 #include "Nodes/Route/FlowNode_SubGraph.h"
 
 #include "Engine/World.h"
-#include "Serialization/MemoryReader.h"
-#include "Serialization/MemoryWriter.h"
 
 #if WITH_EDITOR
 #include "Editor.h"
@@ -36,8 +35,17 @@ UFlowAsset::UFlowAsset(const FObjectInitializer& ObjectInitializer)
 	, AllowedNodeClasses({UFlowNode::StaticClass()})
 	, AllowedInSubgraphNodeClasses({UFlowNode_SubGraph::StaticClass()})
 	, bStartNodePlacedAsGhostNode(false)
+	, bPoolInstances(false)
+	, InstancePoolSize(8)
+	, InstancePoolPrewarmCount(0)
+	, bLazyNodeInstancing(false)
 	, TemplateAsset(nullptr)
+	, ActiveNodesNum(0)
 	, FinishPolicy(EFlowFinishPolicy::Keep)
+	, bFlowTimersPaused(false)
+	, bAlwaysCallOnSave(false)
+	, bSaveDirty(true)
+	, SaveDataHash(0)
 {
 	if (!AssetGuid.IsValid())
 	{
@@ -76,12 +84,16 @@ void UFlowAsset::PostDuplicate(bool bDuplicateForPIE)
 		AssetGuid = FGuid::NewGuid();
 		Nodes.Empty();
 	}
+
+	CompileGraph();
 }
+#endif
 
 void UFlowAsset::PostLoad()
 {
 	Super::PostLoad();
 
+#if WITH_EDITOR
 	// If we removed or moved a flow node blueprint (and there is no redirector) we might loose the reference to it resulting
 	// in null pointers in the Nodes FGUID->UFlowNode* Map. So here we iterate over all the Nodes and remove all pairs that
 	// are nulled out.
@@ -100,8 +112,12 @@ void UFlowAsset::PostLoad()
 	{
 		UnregisterNode(Guid);
 	}
+#endif
+
+	CompileGraph();
 }
 
+#if WITH_EDITOR
 EDataValidationResult UFlowAsset::ValidateAsset(FFlowMessageLog& MessageLog)
 {
 	// validate nodes
@@ -373,11 +389,74 @@ void UFlowAsset::HarvestNodeConnections()
 			Node->PostEditChange();
 		}
 	}
+
+	CompileGraph();
 }
 #endif
 
+void UFlowAsset::CompileGraph()
+{
+	CompiledGraph = FFlowCompiledGraph::Compile(Nodes);
+}
+
+TConstArrayView<FConnectedPin> UFlowAsset::GetInputConnections(const FGuid& NodeGuid, const FName& PinName) const
+{
+	if (CompiledGraph.IsValid())
+	{
+		const int32 NodeIndex = CompiledGraph->FindNodeIndex(NodeGuid);
+		if (NodeIndex != INDEX_NONE)
+		{
+			return CompiledGraph->GetInputConnections(NodeIndex, CompiledGraph->FindInputPinIndex(NodeIndex, PinName));
+		}
+	}
+
+	return TConstArrayView<FConnectedPin>();
+}
+
+UFlowNode* UFlowAsset::GetNodeByIndex(const int32 NodeIndex) const
+{
+	if (IndexedNodes.IsValidIndex(NodeIndex) && IndexedNodes[NodeIndex])
+	{
+		return IndexedNodes[NodeIndex];
+	}
+
+	// template asset doesn't keep indexed nodes, lazy instance keeps template nodes until instancing them
+	if (CompiledGraph.IsValid() && NodeIndex >= 0 && NodeIndex < CompiledGraph->Num())
+	{
+		return Nodes.FindRef(CompiledGraph->GetNode(NodeIndex).NodeGuid);
+	}
+
+	return nullptr;
+}
+
+UFlowNode* UFlowAsset::GetNodeInstance(const FGuid& NodeGuid)
+{
+	if (CompiledGraph.IsValid() && IndexedNodes.Num() > 0)
+	{
+		return GetNodeInstanceByIndex(CompiledGraph->FindNodeIndex(NodeGuid));
+	}
+
+	return Nodes.FindRef(NodeGuid);
+}
+
+UFlowNode* UFlowAsset::GetNodeInstanceByIndex(const int32 NodeIndex)
+{
+	if (!IndexedNodes.IsValidIndex(NodeIndex))
+	{
+		return nullptr;
+	}
+
+	return IndexedNodes[NodeIndex] ? IndexedNodes[NodeIndex] : CreateNodeInstance(NodeIndex);
+}
+
 UFlowNode* UFlowAsset::GetDefaultEntryNode() const
 {
+	if (CompiledGraph.IsValid())
+	{
+		return GetNodeByIndex(CompiledGraph->GetEntryNodeIndex());
+	}
+
+	// graph not compiled yet, i.e. asset just created in the editor
 	UFlowNode* FirstStartNode = nullptr;
 
 	for (const TPair<FGuid, UFlowNode*>& Node : Nodes)
@@ -435,11 +514,28 @@ void UFlowAsset::RemoveCustomOutput(const FName& EventName)
 
 UFlowNode_CustomInput* UFlowAsset::TryFindCustomInputNodeByEventName(const FName& EventName) const
 {
-	for (UFlowNode_CustomInput* InputNode : CustomInputNodes)
+	if (CompiledGraph.IsValid())
+	{
+		for (const int32 NodeIndex : CompiledGraph->FindCustomInputNodes(EventName))
+		{
+			UFlowNode_CustomInput* InputNode = Cast<UFlowNode_CustomInput>(GetNodeByIndex(NodeIndex));
+			if (IsValid(InputNode))
+			{
+				return InputNode;
+			}
+		}
+
+		return nullptr;
+	}
+
+	for (const TPair<FGuid, UFlowNode*>& Node : Nodes)
 	{
-		if (IsValid(InputNode) && InputNode->GetEventName() == EventName)
+		if (UFlowNode_CustomInput* InputNode = Cast<UFlowNode_CustomInput>(Node.Value))
 		{
-			return InputNode;
+			if (InputNode->GetEventName() == EventName)
+			{
+				return InputNode;
+			}
 		}
 	}
 
@@ -448,6 +544,11 @@ UFlowNode_CustomInput* UFlowAsset::TryFindCustomInputNodeByEventName(const FName
 
 UFlowNode_CustomOutput* UFlowAsset::TryFindCustomOutputNodeByEventName(const FName& EventName) const
 {
+	if (CompiledGraph.IsValid())
+	{
+		return Cast<UFlowNode_CustomOutput>(GetNodeByIndex(CompiledGraph->FindCustomOutputNode(EventName)));
+	}
+
 	for (const TPair<FGuid, UFlowNode*>& Node : Nodes)
 	{
 		if (UFlowNode_CustomOutput* CustomOutput = Cast<UFlowNode_CustomOutput>(Node.Value))
@@ -601,30 +702,51 @@ void UFlowAsset::InitializeInstance(const TWeakObjectPtr<UObject> InOwner, UFlow
 	Owner = InOwner;
 	TemplateAsset = InTemplateAsset;
 
-	for (TPair<FGuid, UFlowNode*>& Node : Nodes)
+	// templates created at runtime weren't loaded, so they're compiled by the first instance
+	if (!InTemplateAsset->CompiledGraph.IsValid())
 	{
-		UFlowNode* NewNodeInstance = NewObject<UFlowNode>(this, Node.Value->GetClass(), NAME_None, RF_Transient, Node.Value, false, nullptr);
-		Node.Value = NewNodeInstance;
+		InTemplateAsset->CompileGraph();
+	}
+	CompiledGraph = InTemplateAsset->CompiledGraph;
+	IndexedNodes.SetNumZeroed(CompiledGraph->Num());
 
-		if (UFlowNode_CustomInput* CustomInput = Cast<UFlowNode_CustomInput>(NewNodeInstance))
+	// lazy instance creates node instances on the first trigger or preload, Nodes keep template nodes until then
+	if (!InTemplateAsset->bLazyNodeInstancing)
+	{
+		for (int32 NodeIndex = 0; NodeIndex < IndexedNodes.Num(); NodeIndex++)
 		{
-			if (!CustomInput->EventName.IsNone())
-			{
-				CustomInputNodes.Emplace(CustomInput);
-			}
+			CreateNodeInstance(NodeIndex);
 		}
+	}
+}
 
-		NewNodeInstance->InitializeInstance();
+UFlowNode* UFlowAsset::CreateNodeInstance(const int32 NodeIndex)
+{
+	const FGuid& NodeGuid = CompiledGraph->GetNode(NodeIndex).NodeGuid;
+	UFlowNode* TemplateNode = Nodes.FindRef(NodeGuid);
+	if (TemplateNode == nullptr)
+	{
+		return nullptr;
 	}
+
+	UFlowNode* NewNodeInstance = NewObject<UFlowNode>(this, TemplateNode->GetClass(), NAME_None, RF_Transient, TemplateNode, false, nullptr);
+	NewNodeInstance->InstanceTemplate = TemplateNode;
+	NewNodeInstance->CompiledIndex = NodeIndex;
+
+	Nodes.Add(NodeGuid, NewNodeInstance);
+	IndexedNodes[NodeIndex] = NewNodeInstance;
+
+	NewNodeInstance->InitializeInstance();
+	return NewNodeInstance;
 }
 
 void UFlowAsset::DeinitializeInstance()
 {
-	for (const TPair<FGuid, UFlowNode*>& Node : Nodes)
+	for (UFlowNode* Node : IndexedNodes)
 	{
-		if (IsValid(Node.Value))
+		if (IsValid(Node))
 		{
-			Node.Value->DeinitializeInstance();
+			Node->DeinitializeInstance();
 		}
 	}
 
@@ -635,6 +757,62 @@ void UFlowAsset::DeinitializeInstance()
 		{
 			GetFlowSubsystem()->RemoveInstancedTemplate(TemplateAsset);
 		}
+
+		if (TemplateAsset->bPoolInstances && GetFlowSubsystem())
+		{
+			GetFlowSubsystem()->ReleaseFlowInstance(this);
+		}
+	}
+}
+
+void UFlowAsset::ResetInstance()
+{
+	Owner.Reset();
+	NodeOwningThisAssetInstance.Reset();
+	ActiveSubGraphs.Empty();
+
+	PreloadedNodes.Empty();
+	ActiveNodes.Empty();
+	ActiveNodesNum = 0;
+	ResetNodes();
+
+	FinishPolicy = EFlowFinishPolicy::Keep;
+	bFlowTimersPaused = false;
+	bSaveDirty = true;
+
+	// restore properties of asset subclasses from the template, state of UFlowAsset itself has been reset above
+	if (TemplateAsset)
+	{
+		for (TFieldIterator<FProperty> It(GetClass()); It; ++It)
+		{
+			if (It->GetOwnerClass() != UFlowAsset::StaticClass() && It->GetOwnerClass()->IsChildOf(UFlowAsset::StaticClass())
+				&& !It->ContainsInstancedObjectProperty())
+			{
+				It->CopyCompleteValue_InContainer(this, TemplateAsset);
+			}
+		}
+	}
+
+	for (UFlowNode* Node : IndexedNodes)
+	{
+		if (Node)
+		{
+			Node->ResetInstance();
+		}
+	}
+}
+
+void UFlowAsset::ReinitializeInstance(const TWeakObjectPtr<UObject> InOwner)
+{
+	Owner = InOwner;
+
+	// node instances and the compiled graph are kept from the previous use
+	for (UFlowNode* Node : IndexedNodes)
+	{
+		if (Node)
+		{
+			Node->InitializeInstance();
+		}
 	}
 }
 
@@ -662,6 +840,12 @@ void UFlowAsset::StartFlow()
 
 	if (UFlowNode* ConnectedEntryNode = GetDefaultEntryNode())
 	{
+		// entry node of the lazy instance might be the template node
+		if (ConnectedEntryNode->GetOuter() != this)
+		{
+			ConnectedEntryNode = GetNodeInstance(ConnectedEntryNode->GetGuid());
+		}
+
 		RecordedNodes.Add(ConnectedEntryNode);
 		ConnectedEntryNode->TriggerFirstOutput(true);
 	}
@@ -669,14 +853,22 @@ void UFlowAsset::StartFlow()
 
 void UFlowAsset::FinishFlow(const EFlowFinishPolicy InFinishPolicy, const bool bRemoveInstance /*= true*/)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlowFinishFlow);
+	FFlowTrace::OutputInstanceFinished(*this);
+
 	FinishPolicy = InFinishPolicy;
 
 	// end execution of this asset and all of its nodes
 	for (UFlowNode* Node : ActiveNodes)
 	{
-		Node->Deactivate();
+		if (Node)
+		{
+			Node->ActiveNodeIndex = INDEX_NONE;
+			Node->Deactivate();
+		}
 	}
 	ActiveNodes.Empty();
+	ActiveNodesNum = 0;
 
 	// flush preloaded content
 	for (UFlowNode* PreloadedNode : PreloadedNodes)
@@ -685,6 +877,15 @@ void UFlowAsset::FinishFlow(const EFlowFinishPolicy InFinishPolicy, const bool b
 	}
 	PreloadedNodes.Empty();
 
+	// referenced assets aren't needed anymore
+	LoadHandles.Empty();
+
+	// signals sent to this instance won't be delivered anymore
+	if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
+	{
+		FlowSubsystem->DiscardQueuedSignals(this);
+	}
+
 	// provides option to finish game-specific logic prior to removing asset instance 
 	if (bRemoveInstance)
 	{
@@ -724,9 +925,9 @@ void UFlowAsset::TriggerCustomInput_FromSubGraph(UFlowNode_SubGraph* Node, const
 
 void UFlowAsset::TriggerCustomInput(const FName& EventName)
 {
-	for (UFlowNode_CustomInput* CustomInput : CustomInputNodes)
+	for (const int32 NodeIndex : CompiledGraph->FindCustomInputNodes(EventName))
 	{
-		if (CustomInput->EventName == EventName)
+		if (UFlowNode_CustomInput* CustomInput = Cast<UFlowNode_CustomInput>(GetNodeInstanceByIndex(NodeIndex)))
 		{
 			RecordedNodes.Add(CustomInput);
 			CustomInput->ExecuteInput(EventName);
@@ -751,24 +952,71 @@ void UFlowAsset::TriggerCustomOutput(const FName& EventName)
 
 void UFlowAsset::TriggerInput(const FGuid& NodeGuid, const FName& PinName)
 {
-	if (UFlowNode* Node = Nodes.FindRef(NodeGuid))
+	if (UFlowNode* Node = GetNodeInstance(NodeGuid))
 	{
-		if (!ActiveNodes.Contains(Node))
+		const uint16 InputPinIndex = Node->FindInputPinIndex(PinName);
+		if (InputPinIndex == UFlowNode::InvalidPinIndex)
 		{
-			ActiveNodes.Add(Node);
-			RecordedNodes.Add(Node);
+#if !UE_BUILD_SHIPPING
+			Node->LogError(FString::Printf(TEXT("Input Pin name %s invalid"), *PinName.ToString()));
+#endif
+			return;
 		}
 
-		Node->TriggerInput(PinName);
+		TriggerInput(Node, InputPinIndex);
 	}
 }
 
-void UFlowAsset::FinishNode(UFlowNode* Node)
+void UFlowAsset::TriggerInput(UFlowNode* Node, const uint16 InputPinIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowTriggerInput);
+
+	// template node of the lazy instance, i.e. found by GetNodeByIndex() before it was instanced
+	if (Node->GetOuter() != this)
+	{
+		Node = GetNodeInstance(Node->GetGuid());
+		if (Node == nullptr)
+		{
+			return;
+		}
+	}
+
+	if (UFlowSettings::Get()->bQueuedExecution)
+	{
+		if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
+		{
+			FlowSubsystem->QueueSignal(this, Node, InputPinIndex);
+			return;
+		}
+	}
+
+	ExecuteTriggerInput(Node, InputPinIndex);
+}
+
+void UFlowAsset::ExecuteTriggerInput(UFlowNode* Node, const uint16 InputPinIndex)
 {
-	if (ActiveNodes.Contains(Node))
+	// node can't be activated by the signal it won't handle
+	if (!Node->InputPins.IsValidIndex(InputPinIndex))
+	{
+#if !UE_BUILD_SHIPPING
+		Node->LogError(FString::Printf(TEXT("Input Pin index %d invalid"), InputPinIndex));
+#endif
+		return;
+	}
+
+	if (Node->ActiveNodeIndex == INDEX_NONE)
 	{
-		ActiveNodes.Remove(Node);
+		AddActiveNode(Node);
+		RecordedNodes.Add(Node);
+	}
+
+	Node->TriggerInputByIndex(InputPinIndex);
+}
 
+void UFlowAsset::FinishNode(UFlowNode* Node)
+{
+	if (RemoveActiveNode(Node))
+	{
 		// if graph reached Finish and this asset instance was created by SubGraph node
 		if (Node->CanFinishGraph())
 		{
@@ -794,6 +1042,58 @@ void UFlowAsset::ResetNodes()
 	RecordedNodes.Empty();
 }
 
+void UFlowAsset::AddActiveNode(UFlowNode* Node)
+{
+	Node->ActiveNodeIndex = ActiveNodes.Add(Node);
+	ActiveNodesNum++;
+}
+
+bool UFlowAsset::RemoveActiveNode(UFlowNode* Node)
+{
+	if (Node->ActiveNodeIndex == INDEX_NONE || !ActiveNodes.IsValidIndex(Node->ActiveNodeIndex) || ActiveNodes[Node->ActiveNodeIndex] != Node)
+	{
+		return false;
+	}
+
+	ActiveNodes[Node->ActiveNodeIndex] = nullptr;
+	Node->ActiveNodeIndex = INDEX_NONE;
+	ActiveNodesNum--;
+
+	// amortized cleanup of empty slots
+	if (ActiveNodes.Num() > 16 && ActiveNodesNum * 2 < ActiveNodes.Num())
+	{
+		CompactActiveNodes();
+	}
+
+	return true;
+}
+
+void UFlowAsset::CompactActiveNodes()
+{
+	if (ActiveNodesNum == ActiveNodes.Num())
+	{
+		return;
+	}
+
+	int32 NewIndex = 0;
+	for (int32 i = 0; i < ActiveNodes.Num(); i++)
+	{
+		if (UFlowNode* Node = ActiveNodes[i])
+		{
+			Node->ActiveNodeIndex = NewIndex;
+			ActiveNodes[NewIndex++] = Node;
+		}
+	}
+	ActiveNodes.SetNum(NewIndex, EAllowShrinking::No);
+}
+
+const TArray<UFlowNode*>& UFlowAsset::GetActiveNodes()
+{
+	// only removes empty slots, doesn't change the order of active nodes
+	CompactActiveNodes();
+	return ActiveNodes;
+}
+
 UFlowSubsystem* UFlowAsset::GetFlowSubsystem() const
 {
 	return Cast<UFlowSubsystem>(GetOuter());
@@ -816,12 +1116,97 @@ UFlowAsset* UFlowAsset::GetParentInstance() const
 
 FFlowAssetSaveData UFlowAsset::SaveInstance(TArray<FFlowAssetSaveData>& SavedFlowInstances)
 {
+	return SaveInstanceInternal(SavedFlowInstances, nullptr);
+}
+
+FFlowAssetSaveData UFlowAsset::SaveInstanceIncremental(TArray<FFlowAssetSaveData>& SavedFlowInstances, FFlowSaveBaseline& Baseline)
+{
+	return SaveInstanceInternal(SavedFlowInstances, &Baseline);
+}
+
+bool UFlowAsset::IsSaveDirty() const
+{
+	if (bSaveDirty)
+	{
+		return true;
+	}
+
+	for (const UFlowNode* ActiveNode : ActiveNodes)
+	{
+		if (ActiveNode && ActiveNode->IsSaveDirty())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UFlowAsset::UpdateSaveDirty()
+{
+	if (bAlwaysCallOnSave && !bSaveDirty)
+	{
+		OnSave();
+		bSaveDirty = FFlowSaveSerialization::HashObject(this) != SaveDataHash;
+	}
+}
+
+FFlowAssetSaveData UFlowAsset::SaveInstanceInternal(TArray<FFlowAssetSaveData>& SavedFlowInstances, FFlowSaveBaseline* Baseline)
+{
+	FFlowAssetSaveData PreviousRecord;
+	const bool bHasPreviousRecord = Baseline && Baseline->FlowInstances.RemoveAndCopyValue(GetName(), PreviousRecord);
+
+	if (bHasPreviousRecord)
+	{
+		// previous records of instances calling OnSave() when clean are reused only if it doesn't produce different data
+		UpdateSaveDirty();
+		for (UFlowNode* ActiveNode : ActiveNodes)
+		{
+			if (ActiveNode)
+			{
+				ActiveNode->UpdateSaveDirty();
+			}
+		}
+	}
+
+	if (bHasPreviousRecord && !IsSaveDirty())
+	{
+		// nothing changed since the previous save, but Sub Graphs have their own records
+		for (const TPair<TWeakObjectPtr<UFlowNode_SubGraph>, TWeakObjectPtr<UFlowAsset>>& SubGraph : ActiveSubGraphs)
+		{
+			if (SubGraph.Key.IsValid() && SubGraph.Value.IsValid())
+			{
+				const FFlowAssetSaveData SubAssetRecord = SubGraph.Value->SaveInstanceInternal(SavedFlowInstances, Baseline);
+				SubGraph.Key->SavedAssetInstanceName = SubAssetRecord.InstanceName;
+			}
+		}
+
+		SavedFlowInstances.Emplace(PreviousRecord);
+		return PreviousRecord;
+	}
+
+	// node records of the previous save, reused for nodes which haven't changed
+	TMap<FGuid, FFlowNodeSaveData*> PreviousNodeRecords;
+	if (bHasPreviousRecord)
+	{
+		PreviousNodeRecords.Reserve(PreviousRecord.NodeRecords.Num());
+		for (FFlowNodeSaveData& PreviousNodeRecord : PreviousRecord.NodeRecords)
+		{
+			PreviousNodeRecords.Add(PreviousNodeRecord.NodeGuid, &PreviousNodeRecord);
+		}
+	}
+
 	FFlowAssetSaveData AssetRecord;
 	AssetRecord.WorldName = IsBoundToWorld() ? GetWorld()->GetName() : FString();
 	AssetRecord.InstanceName = GetName();
+	AssetRecord.SchemaVersion = FFlowSaveVersion::LatestVersion;
 
 	// opportunity to collect data before serializing asset
 	OnSave();
+	if (bAlwaysCallOnSave)
+	{
+		SaveDataHash = FFlowSaveSerialization::HashObject(this);
+	}
 
 	// iterate nodes
 	TArray<UFlowNode*> NodesInExecutionOrder;
@@ -836,22 +1221,33 @@ FFlowAssetSaveData UFlowAsset::SaveInstance(TArray<FFlowAssetSaveData>& SavedFlo
 				const TWeakObjectPtr<UFlowAsset> SubFlowInstance = GetFlowInstance(SubGraphNode);
 				if (SubFlowInstance.IsValid())
 				{
-					const FFlowAssetSaveData SubAssetRecord = SubFlowInstance->SaveInstance(SavedFlowInstances);
+					const FFlowAssetSaveData SubAssetRecord = SubFlowInstance->SaveInstanceInternal(SavedFlowInstances, Baseline);
 					SubGraphNode->SavedAssetInstanceName = SubAssetRecord.InstanceName;
 				}
 			}
 
-			FFlowNodeSaveData NodeRecord;
-			Node->SaveInstance(NodeRecord);
+			FFlowNodeSaveData* PreviousNodeRecord = Node->IsSaveDirty() ? nullptr : PreviousNodeRecords.FindRef(Node->NodeGuid);
+			if (PreviousNodeRecord)
+			{
+				AssetRecord.NodeRecords.Emplace(MoveTemp(*PreviousNodeRecord));
+			}
+			else
+			{
+				FFlowNodeSaveData NodeRecord;
+				Node->SaveInstance(NodeRecord);
 
-			AssetRecord.NodeRecords.Emplace(NodeRecord);
+				AssetRecord.NodeRecords.Emplace(NodeRecord);
+			}
 		}
 	}
 
 	// serialize asset
-	FMemoryWriter MemoryWriter(AssetRecord.AssetData, true);
-	FFlowArchive Ar(MemoryWriter);
-	Serialize(Ar);
+	UFlowSubsystem* FlowSubsystem = GetFlowSubsystem();
+	if (FlowSubsystem == nullptr || !FlowSubsystem->DeferSerialization(this, AssetRecord.PendingSerialization))
+	{
+		FFlowSaveSerialization::SerializeObject(this, AssetRecord.AssetData, AssetRecord.CompressionFormat, AssetRecord.UncompressedSize);
+	}
+	bSaveDirty = false;
 
 	// write archive to SaveGame
 	SavedFlowInstances.Emplace(AssetRecord);
@@ -861,9 +1257,15 @@ FFlowAssetSaveData UFlowAsset::SaveInstance(TArray<FFlowAssetSaveData>& SavedFlo
 
 void UFlowAsset::LoadInstance(const FFlowAssetSaveData& AssetRecord)
 {
-	FMemoryReader MemoryReader(AssetRecord.AssetData, true);
-	FFlowArchive Ar(MemoryReader);
-	Serialize(Ar);
+	SCOPE_CYCLE_COUNTER(STAT_FlowLoad);
+	FLOW_TRACE_SCOPE(Flow_LoadAssetInstance);
+
+	const UFlowSaveGame* SaveGame = GetFlowSubsystem() ? GetFlowSubsystem()->GetLoadedSaveGame() : nullptr;
+	if (!FFlowSaveSerialization::DeserializeObject(this, AssetRecord.AssetData, AssetRecord.CompressionFormat, AssetRecord.UncompressedSize,
+	                                               AssetRecord.SchemaVersion, AssetRecord.bNameTableEncoding, SaveGame))
+	{
+		return;
+	}
 
 	PreStartFlow();
 
@@ -871,7 +1273,7 @@ void UFlowAsset::LoadInstance(const FFlowAssetSaveData& AssetRecord)
 	// prevents issue when the preceding node would instantly fire output to a not-yet-loaded node
 	for (int32 i = AssetRecord.NodeRecords.Num() - 1; i >= 0; i--)
 	{
-		if (UFlowNode* Node = Nodes.FindRef(AssetRecord.NodeRecords[i].NodeGuid))
+		if (UFlowNode* Node = GetNodeInstance(AssetRecord.NodeRecords[i].NodeGuid))
 		{
 			Node->LoadInstance(AssetRecord.NodeRecords[i]);
 		}
@@ -887,9 +1289,9 @@ void UFlowAsset::OnActivationStateLoaded(UFlowNode* Node)
 		RecordedNodes.Emplace(Node);
 	}
 
-	if (Node->ActivationState == EFlowNodeState::Active)
+	if (Node->ActivationState == EFlowNodeState::Active && Node->ActiveNodeIndex == INDEX_NONE)
 	{
-		ActiveNodes.Emplace(Node);
+		AddActiveNode(Node);
 	}
 }
 
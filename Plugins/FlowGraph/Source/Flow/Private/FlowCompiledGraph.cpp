@@ -0,0 +1,239 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "FlowCompiledGraph.h"
+#include "Nodes/FlowNode.h"
+#include "Nodes/Route/FlowNode_CustomInput.h"
+#include "Nodes/Route/FlowNode_CustomOutput.h"
+#include "Nodes/Route/FlowNode_Start.h"
+
+TSharedRef<const FFlowCompiledGraph> FFlowCompiledGraph::Compile(const TMap<FGuid, UFlowNode*>& TemplateNodes)
+{
+	const TSharedRef<FFlowCompiledGraph> Graph = MakeShared<FFlowCompiledGraph>();
+	Graph->Nodes.Reserve(TemplateNodes.Num());
+	Graph->NodeIndices.Reserve(TemplateNodes.Num());
+
+	// 1st pass: assign indices to nodes and ranges to their pins
+	TArray<const UFlowNode*> SourceNodes;
+	SourceNodes.Reserve(TemplateNodes.Num());
+
+	int32 RoutesNum = 0;
+	int32 InputPinsNum = 0;
+	for (const TPair<FGuid, UFlowNode*>& TemplateNode : TemplateNodes)
+	{
+		const UFlowNode* Node = TemplateNode.Value;
+		if (Node == nullptr)
+		{
+			continue;
+		}
+
+		Graph->NodeIndices.Add(TemplateNode.Key, Graph->Nodes.Num());
+		SourceNodes.Add(Node);
+
+		FFlowCompiledNode& CompiledNode = Graph->Nodes.AddDefaulted_GetRef();
+		CompiledNode.NodeGuid = TemplateNode.Key;
+
+		const TArray<FFlowPin>& InputPins = Node->GetInputPins();
+		CompiledNode.FirstInputPin = InputPinsNum;
+		CompiledNode.InputPinsNum = InputPins.Num();
+		CompiledNode.InputPinIndices.Reserve(InputPins.Num());
+		for (int32 i = 0; i < InputPins.Num(); i++)
+		{
+			CompiledNode.InputPinIndices.FindOrAdd(InputPins[i].PinName, static_cast<uint16>(i));
+		}
+
+		const TArray<FFlowPin>& OutputPins = Node->GetOutputPins();
+		CompiledNode.FirstRoute = RoutesNum;
+		CompiledNode.OutputPinsNum = OutputPins.Num();
+		CompiledNode.OutputPinIndices.Reserve(OutputPins.Num());
+		for (int32 i = 0; i < OutputPins.Num(); i++)
+		{
+			CompiledNode.OutputPinIndices.FindOrAdd(OutputPins[i].PinName, static_cast<uint16>(i));
+		}
+
+		InputPinsNum += InputPins.Num();
+		RoutesNum += OutputPins.Num();
+	}
+
+	// 2nd pass: resolve connections of output pins, counting connections of every input pin
+	Graph->Routes.SetNum(RoutesNum);
+	TArray<int32> InputConnectionsNum;
+	InputConnectionsNum.SetNumZeroed(InputPinsNum);
+
+	for (int32 NodeIndex = 0; NodeIndex < SourceNodes.Num(); NodeIndex++)
+	{
+		const FFlowCompiledNode& CompiledNode = Graph->Nodes[NodeIndex];
+		const TArray<FFlowPin>& OutputPins = SourceNodes[NodeIndex]->GetOutputPins();
+
+		for (int32 i = 0; i < OutputPins.Num(); i++)
+		{
+			const FConnectedPin Connection = SourceNodes[NodeIndex]->GetConnection(OutputPins[i].PinName);
+			const int32 ConnectedNodeIndex = Graph->FindNodeIndex(Connection.NodeGuid);
+			if (ConnectedNodeIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			FFlowCompiledRoute& Route = Graph->Routes[CompiledNode.FirstRoute + i];
+			Route.NodeIndex = ConnectedNodeIndex;
+			Route.InputPinIndex = Graph->FindInputPinIndex(ConnectedNodeIndex, Connection.PinName);
+
+			if (Route.InputPinIndex != UFlowNode::InvalidPinIndex)
+			{
+				InputConnectionsNum[Graph->Nodes[ConnectedNodeIndex].FirstInputPin + Route.InputPinIndex]++;
+			}
+		}
+	}
+
+	// 3rd pass: lay out input connections, so connections of every input pin are contiguous
+	Graph->InputConnectionOffsets.SetNumUninitialized(InputPinsNum + 1);
+	Graph->InputConnectionOffsets[0] = 0;
+	for (int32 Pin = 0; Pin < InputPinsNum; Pin++)
+	{
+		Graph->InputConnectionOffsets[Pin + 1] = Graph->InputConnectionOffsets[Pin] + InputConnectionsNum[Pin];
+	}
+
+	Graph->InputConnections.SetNum(Graph->InputConnectionOffsets[InputPinsNum]);
+
+	// reused as the write position of every input pin
+	InputConnectionsNum.SetNumZeroed(InputPinsNum);
+
+	for (int32 NodeIndex = 0; NodeIndex < SourceNodes.Num(); NodeIndex++)
+	{
+		const FFlowCompiledNode& CompiledNode = Graph->Nodes[NodeIndex];
+		const TArray<FFlowPin>& OutputPins = SourceNodes[NodeIndex]->GetOutputPins();
+
+		for (int32 i = 0; i < OutputPins.Num(); i++)
+		{
+			const FFlowCompiledRoute& Route = Graph->Routes[CompiledNode.FirstRoute + i];
+			if (Route.IsConnected() && Route.InputPinIndex != UFlowNode::InvalidPinIndex)
+			{
+				const int32 Pin = Graph->Nodes[Route.NodeIndex].FirstInputPin + Route.InputPinIndex;
+				Graph->InputConnections[Graph->InputConnectionOffsets[Pin] + InputConnectionsNum[Pin]++] = FConnectedPin(CompiledNode.NodeGuid, OutputPins[i].PinName);
+			}
+		}
+	}
+
+	// entry points and graph outputs, resolved once instead of casting all nodes on every start
+	int32 FirstStartNodeIndex = INDEX_NONE;
+	for (int32 NodeIndex = 0; NodeIndex < SourceNodes.Num(); NodeIndex++)
+	{
+		const UFlowNode* Node = SourceNodes[NodeIndex];
+
+		if (Node->IsA<UFlowNode_Start>())
+		{
+			if (Graph->EntryNodeIndex == INDEX_NONE && Graph->HasConnectedOutput(NodeIndex))
+			{
+				Graph->EntryNodeIndex = NodeIndex;
+			}
+			else if (FirstStartNodeIndex == INDEX_NONE)
+			{
+				FirstStartNodeIndex = NodeIndex;
+			}
+		}
+		else if (const UFlowNode_CustomInput* CustomInput = Cast<UFlowNode_CustomInput>(Node))
+		{
+			if (!CustomInput->GetEventName().IsNone())
+			{
+				Graph->CustomInputNodeIndices.FindOrAdd(CustomInput->GetEventName()).Add(NodeIndex);
+			}
+		}
+		else if (const UFlowNode_CustomOutput* CustomOutput = Cast<UFlowNode_CustomOutput>(Node))
+		{
+			Graph->CustomOutputNodeIndices.FindOrAdd(CustomOutput->GetEventName(), NodeIndex);
+		}
+	}
+
+	// if none of Start nodes has connections, fallback to the first Start node
+	if (Graph->EntryNodeIndex == INDEX_NONE)
+	{
+		Graph->EntryNodeIndex = FirstStartNodeIndex;
+	}
+
+	return Graph;
+}
+
+bool FFlowCompiledGraph::HasConnectedOutput(const int32 NodeIndex) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex))
+	{
+		return false;
+	}
+
+	const FFlowCompiledNode& Node = Nodes[NodeIndex];
+	for (int32 i = 0; i < Node.OutputPinsNum; i++)
+	{
+		if (Routes[Node.FirstRoute + i].IsConnected())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32 FFlowCompiledGraph::FindNodeIndex(const FGuid& NodeGuid) const
+{
+	const int32* FoundIndex = NodeIndices.Find(NodeGuid);
+	return FoundIndex ? *FoundIndex : INDEX_NONE;
+}
+
+uint16 FFlowCompiledGraph::FindInputPinIndex(const int32 NodeIndex, const FName& PinName) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex))
+	{
+		return UFlowNode::InvalidPinIndex;
+	}
+
+	const uint16* FoundIndex = Nodes[NodeIndex].InputPinIndices.Find(PinName);
+	return FoundIndex ? *FoundIndex : UFlowNode::InvalidPinIndex;
+}
+
+uint16 FFlowCompiledGraph::FindOutputPinIndex(const int32 NodeIndex, const FName& PinName) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex))
+	{
+		return UFlowNode::InvalidPinIndex;
+	}
+
+	const uint16* FoundIndex = Nodes[NodeIndex].OutputPinIndices.Find(PinName);
+	return FoundIndex ? *FoundIndex : UFlowNode::InvalidPinIndex;
+}
+
+const FFlowCompiledRoute* FFlowCompiledGraph::FindRoute(const int32 NodeIndex, const uint16 OutputPinIndex) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex))
+	{
+		return nullptr;
+	}
+
+	const FFlowCompiledNode& Node = Nodes[NodeIndex];
+	return OutputPinIndex < Node.OutputPinsNum ? &Routes[Node.FirstRoute + OutputPinIndex] : nullptr;
+}
+
+TConstArrayView<FConnectedPin> FFlowCompiledGraph::GetInputConnections(const int32 NodeIndex, const uint16 InputPinIndex) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex) || InputPinIndex >= Nodes[NodeIndex].InputPinsNum)
+	{
+		return TConstArrayView<FConnectedPin>();
+	}
+
+	const FFlowCompiledNode& Node = Nodes[NodeIndex];
+	const int32 Pin = Node.FirstInputPin + InputPinIndex;
+	return TConstArrayView<FConnectedPin>(InputConnections.GetData() + InputConnectionOffsets[Pin], InputConnectionOffsets[Pin + 1] - InputConnectionOffsets[Pin]);
+}
+
+TConstArrayView<int32> FFlowCompiledGraph::FindCustomInputNodes(const FName& EventName) const
+{
+	if (const TArray<int32>* FoundIndices = CustomInputNodeIndices.Find(EventName))
+	{
+		return *FoundIndices;
+	}
+
+	return TConstArrayView<int32>();
+}
+
+int32 FFlowCompiledGraph::FindCustomOutputNode(const FName& EventName) const
+{
+	const int32* FoundIndex = CustomOutputNodeIndices.Find(EventName);
+	return FoundIndex ? *FoundIndex : INDEX_NONE;
+}
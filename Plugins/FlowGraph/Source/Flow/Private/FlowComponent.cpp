@@ -4,6 +4,7 @@
 
 #include "FlowAsset.h"
 #include "FlowLogChannels.h"
+#include "FlowProfiler.h"
 #include "FlowSettings.h"
 #include "FlowSubsystem.h"
 
@@ -13,8 +14,7 @@
 #include "Engine/World.h"
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
-#include "Serialization/MemoryReader.h"
-#include "Serialization/MemoryWriter.h"
+#include "TimerManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FlowComponent)
 
@@ -24,6 +24,9 @@ UFlowComponent::UFlowComponent(const FObjectInitializer& ObjectInitializer)
 	, bAutoStartRootFlow(true)
 	, RootFlowMode(EFlowNetMode::Authority)
 	, bAllowMultipleInstances(true)
+	, bAlwaysCallOnSave(false)
+	, bSaveDirty(true)
+	, SaveDataHash(0)
 {
 	PrimaryComponentTick.bCanEverTick = false;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
@@ -31,6 +34,13 @@ UFlowComponent::UFlowComponent(const FObjectInitializer& ObjectInitializer)
 	SetIsReplicatedByDefault(true);
 }
 
+void UFlowComponent::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	ReplicatedEvents.Owner = this;
+}
+
 void UFlowComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -39,22 +49,174 @@ void UFlowComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 	FDoRepLifetimeParams Params;
 	Params.bIsPushBased = true;
 
-	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, AddedIdentityTags, Params);
-	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, RemovedIdentityTags, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, ReplicatedEvents, Params);
+
+	FDoRepLifetimeParams InitialParams;
+	InitialParams.bIsPushBased = true;
+	InitialParams.Condition = COND_InitialOnly;
 
-	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, RecentlySentNotifyTags, Params);
-	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, NotifyTagsFromGraph, Params);
-	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, NotifyTagsFromAnotherComponent, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFlowComponent, IdentityTagsDelta, InitialParams);
 #else
-	DOREPLIFETIME(UFlowComponent, AddedIdentityTags);
-	DOREPLIFETIME(UFlowComponent, RemovedIdentityTags);
+	DOREPLIFETIME(UFlowComponent, ReplicatedEvents);
+	DOREPLIFETIME_CONDITION(UFlowComponent, IdentityTagsDelta, COND_InitialOnly);
+#endif
+}
+
+void UFlowComponent::EnqueueReplicatedEvent(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags, const FGameplayTag& ActorTag /* = FGameplayTag()*/)
+{
+	if (!IsNetMode(NM_DedicatedServer) && !IsNetMode(NM_ListenServer))
+	{
+		return;
+	}
+
+	ReplicatedEvents.Enqueue(Type, Tags, ActorTag, GetWorld()->GetTimeSeconds());
+#if WITH_PUSH_MODEL
+	MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, ReplicatedEvents, this);
+#endif
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(ReplicatedEventsExpirationHandle))
+	{
+		TimerManager.SetTimer(ReplicatedEventsExpirationHandle, this, &UFlowComponent::RemoveExpiredReplicatedEvents, UFlowSettings::Get()->ReplicatedEventsRetentionTime, false);
+	}
+}
+
+void UFlowComponent::RemoveExpiredReplicatedEvents()
+{
+	const float RetentionTime = UFlowSettings::Get()->ReplicatedEventsRetentionTime;
+
+	const bool bAnyEventLeft = ReplicatedEvents.RemoveExpiredEvents(GetWorld()->GetTimeSeconds(), RetentionTime);
+#if WITH_PUSH_MODEL
+	MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, ReplicatedEvents, this);
+#endif
+
+	if (bAnyEventLeft)
+	{
+		GetWorld()->GetTimerManager().SetTimer(ReplicatedEventsExpirationHandle, this, &UFlowComponent::RemoveExpiredReplicatedEvents, RetentionTime, false);
+	}
+}
+
+void UFlowComponent::ApplyReplicatedEvent(const FFlowReplicatedEvent& Event)
+{
+	switch (Event.Type)
+	{
+		case EFlowReplicatedEventType::AddedIdentityTags:
+		case EFlowReplicatedEventType::RemovedIdentityTags:
+			// change has been already applied from the initial state
+			if (Event.Sequence > IdentityTagsDelta.Sequence)
+			{
+				ApplyReplicatedIdentityTags(Event.Type, Event.Tags);
+			}
+			break;
+		case EFlowReplicatedEventType::NotifyGraph:
+			RecentlySentNotifyTags = Event.Tags;
+			BroadcastSentNotifyTags();
+			break;
+		case EFlowReplicatedEventType::NotifyFromGraph:
+			for (const FGameplayTag& NotifyTag : Event.Tags)
+			{
+				ReceiveNotify.Broadcast(nullptr, NotifyTag);
+			}
+			break;
+		case EFlowReplicatedEventType::NotifyActor:
+			if (const UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
+			{
+				for (const TWeakObjectPtr<UFlowComponent>& Component : FlowSubsystem->GetComponents<UFlowComponent>(Event.ActorTag))
+				{
+					for (const FGameplayTag& NotifyTag : Event.Tags)
+					{
+						Component->ReceiveNotify.Broadcast(this, NotifyTag);
+					}
+				}
+			}
+			break;
+		default: ;
+	}
+}
+
+void UFlowComponent::UpdateIdentityTagsDelta(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags)
+{
+	if (!IsNetMode(NM_DedicatedServer) && !IsNetMode(NM_ListenServer))
+	{
+		return;
+	}
+
+	if (Type == EFlowReplicatedEventType::AddedIdentityTags)
+	{
+		IdentityTagsDelta.AddedTags.AppendTags(Tags);
+		IdentityTagsDelta.RemovedTags.RemoveTags(Tags);
+	}
+	else
+	{
+		IdentityTagsDelta.RemovedTags.AppendTags(Tags);
+		IdentityTagsDelta.AddedTags.RemoveTags(Tags);
+	}
 
-	DOREPLIFETIME(UFlowComponent, RecentlySentNotifyTags);
-	DOREPLIFETIME(UFlowComponent, NotifyTagsFromGraph);
-	DOREPLIFETIME(UFlowComponent, NotifyTagsFromAnotherComponent);
+	IdentityTagsDelta.Sequence = ReplicatedEvents.GetLastSequence();
+#if WITH_PUSH_MODEL
+	MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, IdentityTagsDelta, this);
 #endif
 }
 
+void UFlowComponent::OnRep_IdentityTagsDelta()
+{
+	ApplyReplicatedIdentityTags(EFlowReplicatedEventType::AddedIdentityTags, IdentityTagsDelta.AddedTags);
+	ApplyReplicatedIdentityTags(EFlowReplicatedEventType::RemovedIdentityTags, IdentityTagsDelta.RemovedTags);
+}
+
+void UFlowComponent::ApplyReplicatedIdentityTags(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags)
+{
+	const bool bAdded = Type == EFlowReplicatedEventType::AddedIdentityTags;
+
+	FGameplayTagContainer ChangedTags;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		if (IdentityTags.HasTagExact(Tag) != bAdded)
+		{
+			ChangedTags.AddTag(Tag);
+		}
+	}
+
+	if (ChangedTags.IsEmpty())
+	{
+		return;
+	}
+
+	if (bAdded)
+	{
+		IdentityTags.AppendTags(ChangedTags);
+	}
+	else
+	{
+		IdentityTags.RemoveTags(ChangedTags);
+	}
+
+	// the initial state is received before BeginPlay, the component registers with all its tags then
+	if (!HasBegunPlay())
+	{
+		return;
+	}
+
+	if (bAdded)
+	{
+		OnIdentityTagsAdded.Broadcast(this, ChangedTags);
+
+		if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
+		{
+			FlowSubsystem->OnIdentityTagsAdded(this, ChangedTags);
+		}
+	}
+	else
+	{
+		OnIdentityTagsRemoved.Broadcast(this, ChangedTags);
+
+		if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
+		{
+			FlowSubsystem->OnIdentityTagsRemoved(this, ChangedTags);
+		}
+	}
+}
+
 void UFlowComponent::BeginPlay()
 {
 	Super::BeginPlay();
@@ -124,14 +286,10 @@ void UFlowComponent::AddIdentityTag(const FGameplayTag Tag, const EFlowNetMode N
 				FlowSubsystem->OnIdentityTagAdded(this, Tag);
 			}
 
-			if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-			{
-				AddedIdentityTags = FGameplayTagContainer(Tag);
-#if WITH_PUSH_MODEL
-				MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, AddedIdentityTags, this);
-#endif
-			}
+			EnqueueReplicatedEvent(EFlowReplicatedEventType::AddedIdentityTags, FGameplayTagContainer(Tag));
 		}
+
+		UpdateIdentityTagsDelta(EFlowReplicatedEventType::AddedIdentityTags, FGameplayTagContainer(Tag));
 	}
 }
 
@@ -159,13 +317,12 @@ void UFlowComponent::AddIdentityTags(FGameplayTagContainer Tags, const EFlowNetM
 				FlowSubsystem->OnIdentityTagsAdded(this, ValidatedTags);
 			}
 
-			if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-			{
-				AddedIdentityTags = ValidatedTags;
-#if WITH_PUSH_MODEL
-				MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, AddedIdentityTags, this);
-#endif
-			}
+			EnqueueReplicatedEvent(EFlowReplicatedEventType::AddedIdentityTags, ValidatedTags);
+		}
+
+		if (ValidatedTags.Num() > 0)
+		{
+			UpdateIdentityTagsDelta(EFlowReplicatedEventType::AddedIdentityTags, ValidatedTags);
 		}
 	}
 }
@@ -185,14 +342,10 @@ void UFlowComponent::RemoveIdentityTag(const FGameplayTag Tag, const EFlowNetMod
 				FlowSubsystem->OnIdentityTagRemoved(this, Tag);
 			}
 
-			if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-			{
-				RemovedIdentityTags = FGameplayTagContainer(Tag);
-#if WITH_PUSH_MODEL
-				MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, RemovedIdentityTags, this);
-#endif
-			}
+			EnqueueReplicatedEvent(EFlowReplicatedEventType::RemovedIdentityTags, FGameplayTagContainer(Tag));
 		}
+
+		UpdateIdentityTagsDelta(EFlowReplicatedEventType::RemovedIdentityTags, FGameplayTagContainer(Tag));
 	}
 }
 
@@ -220,36 +373,13 @@ void UFlowComponent::RemoveIdentityTags(FGameplayTagContainer Tags, const EFlowN
 				FlowSubsystem->OnIdentityTagsRemoved(this, ValidatedTags);
 			}
 
-			if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-			{
-				RemovedIdentityTags = ValidatedTags;
-#if WITH_PUSH_MODEL
-				MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, RemovedIdentityTags, this);
-#endif
-			}
+			EnqueueReplicatedEvent(EFlowReplicatedEventType::RemovedIdentityTags, ValidatedTags);
 		}
-	}
-}
 
-void UFlowComponent::OnRep_AddedIdentityTags()
-{
-	IdentityTags.AppendTags(AddedIdentityTags);
-	OnIdentityTagsAdded.Broadcast(this, AddedIdentityTags);
-
-	if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
-	{
-		FlowSubsystem->OnIdentityTagsAdded(this, AddedIdentityTags);
-	}
-}
-
-void UFlowComponent::OnRep_RemovedIdentityTags()
-{
-	IdentityTags.RemoveTags(RemovedIdentityTags);
-	OnIdentityTagsRemoved.Broadcast(this, RemovedIdentityTags);
-
-	if (UFlowSubsystem* FlowSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UFlowSubsystem>())
-	{
-		FlowSubsystem->OnIdentityTagsRemoved(this, RemovedIdentityTags);
+		if (ValidatedTags.Num() > 0)
+		{
+			UpdateIdentityTagsDelta(EFlowReplicatedEventType::RemovedIdentityTags, ValidatedTags);
+		}
 	}
 }
 
@@ -295,16 +425,10 @@ void UFlowComponent::NotifyGraph(const FGameplayTag NotifyTag, const EFlowNetMod
 	if (IsFlowNetMode(NetMode) && NotifyTag.IsValid() && HasBegunPlay())
 	{
 		// save recently notify, this allow for the retroactive check in nodes
-		// if retroactive check wouldn't be performed, this is only used by the network replication
 		RecentlySentNotifyTags = FGameplayTagContainer(NotifyTag);
-#if WITH_PUSH_MODEL
-		if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-		{
-			MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, RecentlySentNotifyTags, this);
-		}
-#endif
+		EnqueueReplicatedEvent(EFlowReplicatedEventType::NotifyGraph, RecentlySentNotifyTags);
 
-		OnRep_SentNotifyTags();
+		BroadcastSentNotifyTags();
 	}
 }
 
@@ -324,21 +448,15 @@ void UFlowComponent::BulkNotifyGraph(const FGameplayTagContainer NotifyTags, con
 		if (ValidatedTags.Num() > 0)
 		{
 			// save recently notify, this allow for the retroactive check in nodes
-			// if retroactive check wouldn't be performed, this is only used by the network replication
 			RecentlySentNotifyTags = ValidatedTags;
-#if WITH_PUSH_MODEL
-			if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-			{
-				MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, RecentlySentNotifyTags, this);
-			}
-#endif
+			EnqueueReplicatedEvent(EFlowReplicatedEventType::NotifyGraph, RecentlySentNotifyTags);
 
-			OnRep_SentNotifyTags();
+			BroadcastSentNotifyTags();
 		}
 	}
 }
 
-void UFlowComponent::OnRep_SentNotifyTags()
+void UFlowComponent::BroadcastSentNotifyTags()
 {
 	for (const FGameplayTag& NotifyTag : RecentlySentNotifyTags)
 	{
@@ -366,25 +484,11 @@ void UFlowComponent::NotifyFromGraph(const FGameplayTagContainer& NotifyTags, co
 				ReceiveNotify.Broadcast(nullptr, ValidatedTag);
 			}
 
-			if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-			{
-				NotifyTagsFromGraph = ValidatedTags;
-#if WITH_PUSH_MODEL
-				MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, NotifyTagsFromGraph, this);
-#endif
-			}
+			EnqueueReplicatedEvent(EFlowReplicatedEventType::NotifyFromGraph, ValidatedTags);
 		}
 	}
 }
 
-void UFlowComponent::OnRep_NotifyTagsFromGraph()
-{
-	for (const FGameplayTag& NotifyTag : NotifyTagsFromGraph)
-	{
-		ReceiveNotify.Broadcast(nullptr, NotifyTag);
-	}
-}
-
 void UFlowComponent::NotifyActor(const FGameplayTag ActorTag, const FGameplayTag NotifyTag, const EFlowNetMode NetMode /* = EFlowNetMode::Authority*/)
 {
 	if (IsFlowNetMode(NetMode) && NotifyTag.IsValid() && HasBegunPlay())
@@ -397,28 +501,7 @@ void UFlowComponent::NotifyActor(const FGameplayTag ActorTag, const FGameplayTag
 			}
 		}
 
-		if (IsNetMode(NM_DedicatedServer) || IsNetMode(NM_ListenServer))
-		{
-			NotifyTagsFromAnotherComponent.Empty();
-			NotifyTagsFromAnotherComponent.Add(FNotifyTagReplication(ActorTag, NotifyTag));
-#if WITH_PUSH_MODEL
-			MARK_PROPERTY_DIRTY_FROM_NAME(UFlowComponent, NotifyTagsFromAnotherComponent, this);
-#endif
-		}
-	}
-}
-
-void UFlowComponent::OnRep_NotifyTagsFromAnotherComponent()
-{
-	if (const UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
-	{
-		for (const FNotifyTagReplication& Notify : NotifyTagsFromAnotherComponent)
-		{
-			for (const TWeakObjectPtr<UFlowComponent>& Component : FlowSubsystem->GetComponents<UFlowComponent>(Notify.ActorTag))
-			{
-				Component->ReceiveNotify.Broadcast(this, Notify.NotifyTag);
-			}
-		}
+		EnqueueReplicatedEvent(EFlowReplicatedEventType::NotifyActor, FGameplayTagContainer(NotifyTag), ActorTag);
 	}
 }
 
@@ -477,14 +560,32 @@ void UFlowComponent::OnTriggerRootFlowOutputEventDispatcher(UFlowAsset* RootFlow
 
 void UFlowComponent::SaveRootFlow(TArray<FFlowAssetSaveData>& SavedFlowInstances)
 {
+	FString NewSavedAssetInstanceName;
 	if (UFlowAsset* FlowAssetInstance = GetRootFlowInstance())
 	{
-		const FFlowAssetSaveData AssetRecord = FlowAssetInstance->SaveInstance(SavedFlowInstances);
-		SavedAssetInstanceName = AssetRecord.InstanceName;
-		return;
+		NewSavedAssetInstanceName = FlowAssetInstance->SaveInstance(SavedFlowInstances).InstanceName;
+	}
+
+	if (NewSavedAssetInstanceName != SavedAssetInstanceName)
+	{
+		SavedAssetInstanceName = NewSavedAssetInstanceName;
+		MarkSaveDirty();
+	}
+}
+
+void UFlowComponent::SaveRootFlowIncremental(TArray<FFlowAssetSaveData>& SavedFlowInstances, FFlowSaveBaseline& Baseline)
+{
+	FString NewSavedAssetInstanceName;
+	if (UFlowAsset* FlowAssetInstance = GetRootFlowInstance())
+	{
+		NewSavedAssetInstanceName = FlowAssetInstance->SaveInstanceIncremental(SavedFlowInstances, Baseline).InstanceName;
 	}
 
-	SavedAssetInstanceName = FString();
+	if (NewSavedAssetInstanceName != SavedAssetInstanceName)
+	{
+		SavedAssetInstanceName = NewSavedAssetInstanceName;
+		MarkSaveDirty();
+	}
 }
 
 void UFlowComponent::LoadRootFlow()
@@ -503,38 +604,55 @@ FFlowComponentSaveData UFlowComponent::SaveInstance()
 	FFlowComponentSaveData ComponentRecord;
 	ComponentRecord.WorldName = GetWorld()->GetName();
 	ComponentRecord.ActorInstanceName = GetOwner()->GetName();
+	ComponentRecord.SchemaVersion = FFlowSaveVersion::LatestVersion;
 
 	// opportunity to collect data before serializing component
 	OnSave();
+	if (bAlwaysCallOnSave)
+	{
+		SaveDataHash = FFlowSaveSerialization::HashObject(this);
+	}
 
 	// serialize component
-	FMemoryWriter MemoryWriter(ComponentRecord.ComponentData, true);
-	FFlowArchive Ar(MemoryWriter);
-	Serialize(Ar);
+	UFlowSubsystem* FlowSubsystem = GetFlowSubsystem();
+	if (FlowSubsystem == nullptr || !FlowSubsystem->DeferSerialization(this, ComponentRecord.PendingSerialization))
+	{
+		FFlowSaveSerialization::SerializeObject(this, ComponentRecord.ComponentData, ComponentRecord.CompressionFormat, ComponentRecord.UncompressedSize);
+	}
+	bSaveDirty = false;
 
 	return ComponentRecord;
 }
 
+void UFlowComponent::UpdateSaveDirty()
+{
+	if (bAlwaysCallOnSave && !bSaveDirty)
+	{
+		OnSave();
+		bSaveDirty = FFlowSaveSerialization::HashObject(this) != SaveDataHash;
+	}
+}
+
 bool UFlowComponent::LoadInstance()
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlowLoad);
+	FLOW_TRACE_SCOPE(Flow_LoadComponentInstance);
+
 	const UFlowSaveGame* SaveGame = GetFlowSubsystem()->GetLoadedSaveGame();
-	if (SaveGame->FlowComponents.Num() > 0)
+	const FFlowComponentSaveData* ComponentRecord = SaveGame->FindFlowComponent(GetWorld()->GetName(), GetOwner()->GetName());
+	if (ComponentRecord == nullptr)
 	{
-		for (const FFlowComponentSaveData& ComponentRecord : SaveGame->FlowComponents)
-		{
-			if (ComponentRecord.WorldName == GetWorld()->GetName() && ComponentRecord.ActorInstanceName == GetOwner()->GetName())
-			{
-				FMemoryReader MemoryReader(ComponentRecord.ComponentData, true);
-				FFlowArchive Ar(MemoryReader);
-				Serialize(Ar);
+		return false;
+	}
 
-				OnLoad();
-				return true;
-			}
-		}
+	if (!FFlowSaveSerialization::DeserializeObject(this, ComponentRecord->ComponentData, ComponentRecord->CompressionFormat, ComponentRecord->UncompressedSize,
+	                                               ComponentRecord->SchemaVersion, ComponentRecord->bNameTableEncoding, SaveGame))
+	{
+		return false;
 	}
 
-	return false;
+	OnLoad();
+	return true;
 }
 
 void UFlowComponent::OnSave_Implementation()
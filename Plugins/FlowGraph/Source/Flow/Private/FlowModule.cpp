@@ -1,15 +1,22 @@
 // Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
 
 #include "FlowModule.h"
+#include "Types/FlowOwnerFunctionRef.h"
 
 #include "Modules/ModuleManager.h"
+#include "UObject/UObjectGlobals.h"
 
 void FFlowModule::StartupModule()
 {
+	ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda([](const FCoreUObjectDelegates::FReplacementObjectMap&)
+	{
+		FFlowOwnerFunctionRef::ResetResolvedFunctions();
+	});
 }
 
 void FFlowModule::ShutdownModule()
 {
+	FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
 }
 
 IMPLEMENT_MODULE(FFlowModule, Flow)
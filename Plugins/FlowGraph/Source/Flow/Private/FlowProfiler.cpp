@@ -0,0 +1,310 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "FlowProfiler.h"
+#include "FlowAsset.h"
+#include "Nodes/FlowNode.h"
+
+#include "Algo/Sort.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_STAT(STAT_FlowTriggerInput);
+DEFINE_STAT(STAT_FlowTriggerOutput);
+DEFINE_STAT(STAT_FlowCreateInstance);
+DEFINE_STAT(STAT_FlowFinishFlow);
+DEFINE_STAT(STAT_FlowSave);
+DEFINE_STAT(STAT_FlowLoad);
+
+DEFINE_STAT(STAT_FlowExecutedInputs);
+DEFINE_STAT(STAT_FlowTriggeredOutputs);
+
+UE_TRACE_CHANNEL_DEFINE(FlowChannel);
+
+UE_TRACE_EVENT_BEGIN(Flow, Signal)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, AssetName)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, FromNode)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, OutputPin)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, ToNode)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, InputPin)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Flow, InstanceCreated)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, TemplateName)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, InstanceName)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Flow, InstanceFinished)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, TemplateName)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, InstanceName)
+UE_TRACE_EVENT_END()
+
+namespace FlowProfiler
+{
+#if STATS || CPUPROFILERTRACE_ENABLED
+	// Cycle counter and trace span registered once per node class
+	struct FNodeClassInfo
+	{
+#if STATS
+		TStatId StatId;
+#endif
+#if CPUPROFILERTRACE_ENABLED
+		uint32 TraceSpecId = 0;
+#endif
+	};
+
+	static TMap<FObjectKey, FNodeClassInfo> NodeClassInfos;
+	static FCriticalSection NodeClassInfosCritical;
+
+	// Called only while stats or the trace are collected, so execution doesn't pay for the lookup otherwise
+	static FNodeClassInfo GetNodeClassInfo(const UClass* NodeClass)
+	{
+		FScopeLock Lock(&NodeClassInfosCritical);
+
+		if (const FNodeClassInfo* NodeClassInfo = NodeClassInfos.Find(NodeClass))
+		{
+			return *NodeClassInfo;
+		}
+
+		FNodeClassInfo& NodeClassInfo = NodeClassInfos.Add(NodeClass);
+#if STATS
+		NodeClassInfo.StatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_FlowNodes>(NodeClass->GetName());
+#endif
+#if CPUPROFILERTRACE_ENABLED
+		NodeClassInfo.TraceSpecId = FCpuProfilerTrace::OutputEventType(*NodeClass->GetName());
+#endif
+		return NodeClassInfo;
+	}
+#endif
+
+#if UE_TRACE_ENABLED || WITH_FLOW_PROFILER
+	static const UFlowAsset* GetTemplateAsset(const UFlowNode& Node)
+	{
+		const UFlowAsset* FlowAsset = Node.GetFlowAsset();
+		if (FlowAsset && FlowAsset->GetTemplateAsset())
+		{
+			return FlowAsset->GetTemplateAsset();
+		}
+
+		return FlowAsset;
+	}
+#endif
+
+#if WITH_FLOW_PROFILER
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Flow.Profiler.Enabled"),
+		bEnabled,
+		TEXT("If true, execution time of Flow nodes is aggregated per node class and per Flow Asset. See Flow.Profiler.Report"));
+
+	static FAutoConsoleCommandWithArgsAndOutputDevice ReportCommand(
+		TEXT("Flow.Profiler.Report"),
+		TEXT("Writes node classes and Flow Assets with the highest exclusive execution time. Optional argument: number of entries, 20 by default"),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			const int32 MaxEntries = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+			FFlowProfiler::Get().Report(Ar, MaxEntries > 0 ? MaxEntries : 20);
+		}));
+
+	static FAutoConsoleCommand ResetCommand(
+		TEXT("Flow.Profiler.Reset"),
+		TEXT("Clears data aggregated by the Flow profiler"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FFlowProfiler::Get().Reset();
+		}));
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Trace
+
+void FFlowTrace::OutputSignal(const UFlowNode& FromNode, const FName& OutputPinName, const UFlowNode& ToNode, const FName& InputPinName)
+{
+#if UE_TRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(FlowChannel))
+	{
+		UE_TRACE_LOG(Flow, Signal, FlowChannel)
+			<< Signal.Cycle(FPlatformTime::Cycles64())
+			<< Signal.AssetName(*GetNameSafe(FlowProfiler::GetTemplateAsset(FromNode)))
+			<< Signal.FromNode(*FromNode.GetName())
+			<< Signal.OutputPin(*OutputPinName.ToString())
+			<< Signal.ToNode(*ToNode.GetName())
+			<< Signal.InputPin(*InputPinName.ToString());
+	}
+#endif
+}
+
+void FFlowTrace::OutputInstanceCreated(const UFlowAsset& Instance)
+{
+#if UE_TRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(FlowChannel))
+	{
+		UE_TRACE_LOG(Flow, InstanceCreated, FlowChannel)
+			<< InstanceCreated.Cycle(FPlatformTime::Cycles64())
+			<< InstanceCreated.TemplateName(*GetNameSafe(Instance.GetTemplateAsset()))
+			<< InstanceCreated.InstanceName(*Instance.GetName());
+	}
+#endif
+}
+
+void FFlowTrace::OutputInstanceFinished(const UFlowAsset& Instance)
+{
+#if UE_TRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(FlowChannel))
+	{
+		UE_TRACE_LOG(Flow, InstanceFinished, FlowChannel)
+			<< InstanceFinished.Cycle(FPlatformTime::Cycles64())
+			<< InstanceFinished.TemplateName(*GetNameSafe(Instance.GetTemplateAsset()))
+			<< InstanceFinished.InstanceName(*Instance.GetName());
+	}
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Profiler
+
+#if WITH_FLOW_PROFILER
+FFlowProfiler& FFlowProfiler::Get()
+{
+	static FFlowProfiler Profiler;
+	return Profiler;
+}
+
+bool FFlowProfiler::IsEnabled()
+{
+	return FlowProfiler::bEnabled;
+}
+
+void FFlowProfiler::BeginNode(const UFlowNode& Node)
+{
+	const UClass* NodeClass = Node.GetClass();
+	const UFlowAsset* TemplateAsset = FlowProfiler::GetTemplateAsset(Node);
+
+	FFlowProfilerEntry& NodeClassEntry = NodeClassEntries.FindOrAdd(NodeClass);
+	if (NodeClassEntry.Name.IsEmpty())
+	{
+		NodeClassEntry.Name = NodeClass->GetName();
+	}
+
+	FFlowProfilerEntry& AssetEntry = AssetEntries.FindOrAdd(TemplateAsset);
+	if (AssetEntry.Name.IsEmpty())
+	{
+		AssetEntry.Name = GetPathNameSafe(TemplateAsset);
+	}
+
+	FStackFrame& Frame = Stack.AddDefaulted_GetRef();
+	Frame.NodeClass = NodeClass;
+	Frame.Asset = TemplateAsset;
+	Frame.ChildCycles = 0;
+	Frame.StartCycles = FPlatformTime::Cycles64();
+}
+
+void FFlowProfiler::EndNode()
+{
+	const uint64 EndCycles = FPlatformTime::Cycles64();
+	if (Stack.Num() == 0)
+	{
+		return;
+	}
+
+	const FStackFrame Frame = Stack.Pop(EAllowShrinking::No);
+	const uint64 InclusiveCycles = EndCycles - Frame.StartCycles;
+	const uint64 ExclusiveCycles = InclusiveCycles - FMath::Min(Frame.ChildCycles, InclusiveCycles);
+
+	if (Stack.Num() > 0)
+	{
+		Stack.Last().ChildCycles += InclusiveCycles;
+	}
+
+	// entries might have been removed by Reset() during execution
+	for (FFlowProfilerEntry* Entry : {NodeClassEntries.Find(Frame.NodeClass), AssetEntries.Find(Frame.Asset)})
+	{
+		if (Entry)
+		{
+			Entry->Calls++;
+			Entry->InclusiveCycles += InclusiveCycles;
+			Entry->ExclusiveCycles += ExclusiveCycles;
+		}
+	}
+}
+
+void FFlowProfiler::Report(FOutputDevice& Ar, const int32 MaxEntries) const
+{
+	ReportEntries(Ar, TEXT("Node classes"), NodeClassEntries, MaxEntries);
+	ReportEntries(Ar, TEXT("Flow Assets"), AssetEntries, MaxEntries);
+}
+
+void FFlowProfiler::ReportEntries(FOutputDevice& Ar, const TCHAR* Title, const TMap<FObjectKey, FFlowProfilerEntry>& Entries, const int32 MaxEntries)
+{
+	TArray<const FFlowProfilerEntry*> SortedEntries;
+	SortedEntries.Reserve(Entries.Num());
+	for (const TPair<FObjectKey, FFlowProfilerEntry>& Entry : Entries)
+	{
+		SortedEntries.Add(&Entry.Value);
+	}
+
+	Algo::SortBy(SortedEntries, [](const FFlowProfilerEntry* Entry) { return Entry->ExclusiveCycles; }, TGreater<>());
+
+	Ar.Logf(TEXT("Flow Profiler: %s (%d)"), Title, Entries.Num());
+	for (int32 Index = 0; Index < FMath::Min(SortedEntries.Num(), MaxEntries); Index++)
+	{
+		const FFlowProfilerEntry& Entry = *SortedEntries[Index];
+		Ar.Logf(TEXT("  %-64s calls %8lld  exclusive %10.3f ms  inclusive %10.3f ms"), *Entry.Name, Entry.Calls,
+		        FPlatformTime::ToMilliseconds64(Entry.ExclusiveCycles), FPlatformTime::ToMilliseconds64(Entry.InclusiveCycles));
+	}
+}
+
+void FFlowProfiler::Reset()
+{
+	NodeClassEntries.Empty();
+	AssetEntries.Empty();
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Node execution scope
+
+FFlowNodeExecutionScope::FFlowNodeExecutionScope(const UFlowNode& Node)
+#if STATS
+	: NodeClassCycleCounter(FThreadStats::IsCollectingData() ? FlowProfiler::GetNodeClassInfo(Node.GetClass()).StatId : TStatId())
+#endif
+{
+	INC_DWORD_STAT(STAT_FlowExecutedInputs);
+
+#if CPUPROFILERTRACE_ENABLED
+	bTraced = UE_TRACE_CHANNELEXPR_IS_ENABLED(FlowChannel | CpuChannel);
+	if (bTraced)
+	{
+		FCpuProfilerTrace::OutputBeginEvent(FlowProfiler::GetNodeClassInfo(Node.GetClass()).TraceSpecId);
+	}
+#endif
+
+#if WITH_FLOW_PROFILER
+	bProfiled = FFlowProfiler::IsEnabled() && IsInGameThread();
+	if (bProfiled)
+	{
+		FFlowProfiler::Get().BeginNode(Node);
+	}
+#endif
+}
+
+FFlowNodeExecutionScope::~FFlowNodeExecutionScope()
+{
+#if WITH_FLOW_PROFILER
+	if (bProfiled)
+	{
+		FFlowProfiler::Get().EndNode();
+	}
+#endif
+
+#if CPUPROFILERTRACE_ENABLED
+	if (bTraced)
+	{
+		FCpuProfilerTrace::OutputEndEvent();
+	}
+#endif
+}
@@ -0,0 +1,407 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "FlowSave.h"
+
+#include "FlowLogChannels.h"
+#include "FlowSettings.h"
+
+#include "Misc/Compression.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/SoftObjectPtr.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FlowSave)
+
+const FGuid FFlowSaveVersion::GUID(0x5C1D2A3E, 0x7B9F4E61, 0xA2D8C04B, 0x39E6F157);
+FCustomVersionRegistration GRegisterFlowSaveVersion(FFlowSaveVersion::GUID, FFlowSaveVersion::LatestVersion, TEXT("FlowSave"));
+
+void FFlowSaveCompression::Compress(TArray<uint8>& InOutData, FName& OutCompressionFormat, int32& OutUncompressedSize)
+{
+	OutCompressionFormat = NAME_None;
+	OutUncompressedSize = 0;
+
+	const UFlowSettings* Settings = UFlowSettings::Get();
+	if (!Settings->bCompressSaveData || InOutData.Num() < Settings->MinCompressedRecordSize)
+	{
+		return;
+	}
+
+	const FName Format = Settings->SaveDataCompressionFormat;
+	int32 CompressedSize = FCompression::CompressMemoryBound(Format, InOutData.Num());
+
+	TArray<uint8> CompressedData;
+	CompressedData.SetNumUninitialized(CompressedSize);
+
+	// keep data uncompressed if it doesn't pay off
+	if (FCompression::CompressMemory(Format, CompressedData.GetData(), CompressedSize, InOutData.GetData(), InOutData.Num()) && CompressedSize < InOutData.Num())
+	{
+		CompressedData.SetNum(CompressedSize, EAllowShrinking::Yes);
+
+		OutCompressionFormat = Format;
+		OutUncompressedSize = InOutData.Num();
+		InOutData = MoveTemp(CompressedData);
+	}
+}
+
+const TArray<uint8>* FFlowSaveCompression::Decompress(const TArray<uint8>& Data, const FName CompressionFormat, const int32 UncompressedSize, TArray<uint8>& Buffer)
+{
+	if (CompressionFormat.IsNone())
+	{
+		return &Data;
+	}
+
+	Buffer.SetNumUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(CompressionFormat, Buffer.GetData(), UncompressedSize, Data.GetData(), Data.Num()))
+	{
+		UE_LOG(LogFlow, Error, TEXT("Failed to decompress Flow save data using %s format"), *CompressionFormat.ToString());
+		return nullptr;
+	}
+
+	return &Buffer;
+}
+
+void FFlowSaveSerialization::SerializeObject(UObject* Object, TArray<uint8>& OutData, FName& OutCompressionFormat, int32& OutUncompressedSize)
+{
+	SerializeObjectUncompressed(Object, OutData);
+	FFlowSaveCompression::Compress(OutData, OutCompressionFormat, OutUncompressedSize);
+}
+
+void FFlowSaveSerialization::SerializeObjectUncompressed(UObject* Object, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+
+	FMemoryWriter MemoryWriter(OutData, true);
+	FFlowArchive Ar(MemoryWriter);
+	Object->Serialize(Ar);
+}
+
+void FFlowSaveSerialization::SerializeObjectWithTables(UObject* Object, TArray<uint8>& OutData, FFlowRecordTables& OutTables)
+{
+	OutData.Reset();
+	OutTables.Reset();
+
+	FMemoryWriter MemoryWriter(OutData, true);
+	FFlowTableArchive Ar(MemoryWriter, OutTables);
+	Object->Serialize(Ar);
+}
+
+uint32 FFlowSaveSerialization::HashObject(UObject* Object)
+{
+	TArray<uint8> Data;
+	SerializeObjectUncompressed(Object, Data);
+
+	return FCrc::MemCrc32(Data.GetData(), Data.Num());
+}
+
+bool FFlowSaveSerialization::DeserializeObject(UObject* Object, const TArray<uint8>& Data, const FName CompressionFormat, const int32 UncompressedSize,
+                                               const int32 SchemaVersion, const bool bNameTableEncoding, const UFlowSaveGame* SaveGame)
+{
+	if (SchemaVersion > FFlowSaveVersion::LatestVersion)
+	{
+		UE_LOG(LogFlow, Error, TEXT("%s saved with newer Flow save version %d, can't be loaded"), *Object->GetName(), SchemaVersion);
+		return false;
+	}
+
+	if (bNameTableEncoding && SaveGame == nullptr)
+	{
+		UE_LOG(LogFlow, Error, TEXT("%s saved with name tables, but there's no SaveGame providing them"), *Object->GetName());
+		return false;
+	}
+
+	TArray<uint8> DecompressedData;
+	const TArray<uint8>* ObjectData = FFlowSaveCompression::Decompress(Data, CompressionFormat, UncompressedSize, DecompressedData);
+	if (ObjectData == nullptr)
+	{
+		UE_LOG(LogFlow, Error, TEXT("Failed to decompress save data of %s"), *Object->GetName());
+		return false;
+	}
+
+	FMemoryReader MemoryReader(*ObjectData, true);
+	if (bNameTableEncoding)
+	{
+		FFlowTableArchive Ar(MemoryReader, *SaveGame, SchemaVersion);
+		Object->Serialize(Ar);
+	}
+	else
+	{
+		FFlowArchive Ar(MemoryReader, SchemaVersion);
+		Object->Serialize(Ar);
+	}
+
+	return true;
+}
+
+int32 FFlowRecordTables::AddName(const FName& Name)
+{
+	if (const int32* ExistingIndex = NameIndices.Find(Name))
+	{
+		return *ExistingIndex;
+	}
+
+	const int32 NewIndex = Names.Add(Name);
+	NameIndices.Add(Name, NewIndex);
+	return NewIndex;
+}
+
+int32 FFlowRecordTables::AddObjectPath(const FSoftObjectPath& ObjectPath)
+{
+	if (const int32* ExistingIndex = ObjectPathIndices.Find(ObjectPath))
+	{
+		return *ExistingIndex;
+	}
+
+	const int32 NewIndex = ObjectPaths.Add(ObjectPath);
+	ObjectPathIndices.Add(ObjectPath, NewIndex);
+	return NewIndex;
+}
+
+void FFlowRecordTables::Reset()
+{
+	Names.Reset();
+	ObjectPaths.Reset();
+	NameOffsets.Reset();
+	ObjectPathOffsets.Reset();
+	NameIndices.Reset();
+	ObjectPathIndices.Reset();
+}
+
+FFlowTableArchive::FFlowTableArchive(FArchive& InInnerArchive, FFlowRecordTables& InRecordTables)
+	: FArchiveProxy(InInnerArchive)
+	, RecordTables(&InRecordTables)
+	, SaveGame(nullptr)
+{
+	ArIsSaveGame = true;
+	InInnerArchive.SetCustomVersion(FFlowSaveVersion::GUID, FFlowSaveVersion::LatestVersion, TEXT("FlowSave"));
+}
+
+FFlowTableArchive::FFlowTableArchive(FArchive& InInnerArchive, const UFlowSaveGame& InSaveGame, const int32 SchemaVersion)
+	: FArchiveProxy(InInnerArchive)
+	, RecordTables(nullptr)
+	, SaveGame(&InSaveGame)
+{
+	ArIsSaveGame = true;
+	InInnerArchive.SetCustomVersion(FFlowSaveVersion::GUID, SchemaVersion, TEXT("FlowSave"));
+}
+
+FArchive& FFlowTableArchive::operator<<(FName& Value)
+{
+	int32 Index = INDEX_NONE;
+	if (IsLoading())
+	{
+		InnerArchive << Index;
+		Value = SaveGame->NameTable.IsValidIndex(Index) ? SaveGame->NameTable[Index] : NAME_None;
+	}
+	else
+	{
+		Index = RecordTables->AddName(Value);
+		RecordTables->NameOffsets.Add(InnerArchive.Tell());
+		InnerArchive << Index;
+	}
+
+	return *this;
+}
+
+FArchive& FFlowTableArchive::operator<<(UObject*& Value)
+{
+	FSoftObjectPath ObjectPath;
+	if (IsSaving() && Value)
+	{
+		ObjectPath = FSoftObjectPath(Value);
+	}
+
+	*this << ObjectPath;
+
+	if (IsLoading())
+	{
+		Value = ObjectPath.IsNull() ? nullptr : ObjectPath.ResolveObject();
+		if (Value == nullptr && !ObjectPath.IsNull())
+		{
+			// same as FFlowArchive, which loads objects if these can't be found
+			Value = ObjectPath.TryLoad();
+		}
+	}
+
+	return *this;
+}
+
+FArchive& FFlowTableArchive::operator<<(FWeakObjectPtr& Value)
+{
+	UObject* Object = Value.Get(true);
+	*this << Object;
+
+	if (IsLoading())
+	{
+		Value = Object;
+	}
+
+	return *this;
+}
+
+FArchive& FFlowTableArchive::operator<<(FSoftObjectPtr& Value)
+{
+	FSoftObjectPath ObjectPath = Value.ToSoftObjectPath();
+	*this << ObjectPath;
+
+	if (IsLoading())
+	{
+		Value = ObjectPath;
+	}
+
+	return *this;
+}
+
+FArchive& FFlowTableArchive::operator<<(FSoftObjectPath& Value)
+{
+	int32 Index = INDEX_NONE;
+	if (IsLoading())
+	{
+		InnerArchive << Index;
+		Value = SaveGame->ObjectPathTable.IsValidIndex(Index) ? SaveGame->ObjectPathTable[Index] : FSoftObjectPath();
+	}
+	else if (Value.IsNull())
+	{
+		// null path doesn't need the table entry
+		InnerArchive << Index;
+	}
+	else
+	{
+		Index = RecordTables->AddObjectPath(Value);
+		RecordTables->ObjectPathOffsets.Add(InnerArchive.Tell());
+		InnerArchive << Index;
+	}
+
+	return *this;
+}
+
+FArchive& FFlowTableArchive::operator<<(FObjectPtr& Value)
+{
+	UObject* Object = Value.Get();
+	*this << Object;
+
+	if (IsLoading())
+	{
+		Value = Object;
+	}
+
+	return *this;
+}
+
+const FFlowAssetSaveData* UFlowSaveGame::FindFlowInstance(const FString& WorldName, const FString& InstanceName) const
+{
+	BuildRecordIndex();
+
+	// the first matching record wins, as it did before records were indexed
+	int32 FoundIndex = INDEX_NONE;
+	for (TMultiMap<uint32, int32>::TConstKeyIterator It(FlowInstanceIndex, GetRecordHash(WorldName, InstanceName)); It; ++It)
+	{
+		const FFlowAssetSaveData& AssetRecord = FlowInstances[It.Value()];
+		if (AssetRecord.InstanceName == InstanceName && AssetRecord.WorldName == WorldName && (FoundIndex == INDEX_NONE || It.Value() < FoundIndex))
+		{
+			FoundIndex = It.Value();
+		}
+	}
+
+	return FoundIndex == INDEX_NONE ? nullptr : &FlowInstances[FoundIndex];
+}
+
+const FFlowComponentSaveData* UFlowSaveGame::FindFlowComponent(const FString& WorldName, const FString& ActorInstanceName) const
+{
+	BuildRecordIndex();
+
+	int32 FoundIndex = INDEX_NONE;
+	for (TMultiMap<uint32, int32>::TConstKeyIterator It(FlowComponentIndex, GetRecordHash(WorldName, ActorInstanceName)); It; ++It)
+	{
+		const FFlowComponentSaveData& ComponentRecord = FlowComponents[It.Value()];
+		if (ComponentRecord.ActorInstanceName == ActorInstanceName && ComponentRecord.WorldName == WorldName && (FoundIndex == INDEX_NONE || It.Value() < FoundIndex))
+		{
+			FoundIndex = It.Value();
+		}
+	}
+
+	return FoundIndex == INDEX_NONE ? nullptr : &FlowComponents[FoundIndex];
+}
+
+void UFlowSaveGame::InvalidateRecordIndex()
+{
+	bRecordIndexValid = false;
+}
+
+void UFlowSaveGame::MergeRecordTables(const FFlowRecordTables& RecordTables, TArray<uint8>& RecordData)
+{
+	// tables might have been loaded from disk or modified directly
+	if (NameTableIndices.Num() != NameTable.Num())
+	{
+		NameTableIndices.Reset();
+		for (int32 i = 0; i < NameTable.Num(); i++)
+		{
+			NameTableIndices.Add(NameTable[i], i);
+		}
+	}
+	if (ObjectPathTableIndices.Num() != ObjectPathTable.Num())
+	{
+		ObjectPathTableIndices.Reset();
+		for (int32 i = 0; i < ObjectPathTable.Num(); i++)
+		{
+			ObjectPathTableIndices.Add(ObjectPathTable[i], i);
+		}
+	}
+
+	// record index to the save index
+	TArray<int32, TInlineAllocator<64>> NameRemap;
+	NameRemap.SetNumUninitialized(RecordTables.Names.Num());
+	for (int32 i = 0; i < RecordTables.Names.Num(); i++)
+	{
+		const FName& Name = RecordTables.Names[i];
+		const int32* ExistingIndex = NameTableIndices.Find(Name);
+		NameRemap[i] = ExistingIndex ? *ExistingIndex : NameTableIndices.Add(Name, NameTable.Add(Name));
+	}
+
+	TArray<int32, TInlineAllocator<16>> ObjectPathRemap;
+	ObjectPathRemap.SetNumUninitialized(RecordTables.ObjectPaths.Num());
+	for (int32 i = 0; i < RecordTables.ObjectPaths.Num(); i++)
+	{
+		const FSoftObjectPath& ObjectPath = RecordTables.ObjectPaths[i];
+		const int32* ExistingIndex = ObjectPathTableIndices.Find(ObjectPath);
+		ObjectPathRemap[i] = ExistingIndex ? *ExistingIndex : ObjectPathTableIndices.Add(ObjectPath, ObjectPathTable.Add(ObjectPath));
+	}
+
+	auto RewriteIndices = [&RecordData](const TArray<int64>& Offsets, const TArrayView<const int32> Remap)
+	{
+		for (const int64 Offset : Offsets)
+		{
+			int32 Index;
+			FMemory::Memcpy(&Index, RecordData.GetData() + Offset, sizeof(int32));
+			Index = Remap[Index];
+			FMemory::Memcpy(RecordData.GetData() + Offset, &Index, sizeof(int32));
+		}
+	};
+
+	RewriteIndices(RecordTables.NameOffsets, NameRemap);
+	RewriteIndices(RecordTables.ObjectPathOffsets, ObjectPathRemap);
+}
+
+void UFlowSaveGame::BuildRecordIndex() const
+{
+	// number check catches records added or removed without invalidating the index
+	if (bRecordIndexValid && FlowInstanceIndex.Num() == FlowInstances.Num() && FlowComponentIndex.Num() == FlowComponents.Num())
+	{
+		return;
+	}
+
+	FlowInstanceIndex.Reset();
+	FlowInstanceIndex.Reserve(FlowInstances.Num());
+	for (int32 i = 0; i < FlowInstances.Num(); i++)
+	{
+		FlowInstanceIndex.Add(GetRecordHash(FlowInstances[i].WorldName, FlowInstances[i].InstanceName), i);
+	}
+
+	FlowComponentIndex.Reset();
+	FlowComponentIndex.Reserve(FlowComponents.Num());
+	for (int32 i = 0; i < FlowComponents.Num(); i++)
+	{
+		FlowComponentIndex.Add(GetRecordHash(FlowComponents[i].WorldName, FlowComponents[i].ActorInstanceName), i);
+	}
+
+	bRecordIndexValid = true;
+}
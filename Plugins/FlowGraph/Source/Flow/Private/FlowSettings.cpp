@@ -8,9 +8,24 @@
 UFlowSettings::UFlowSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, bCreateFlowSubsystemOnClients(true)
+	, MaxReplicatedEvents(64)
+	, ReplicatedEventsRetentionTime(2.0f)
 	, bWarnAboutMissingIdentityTags(true)
+	, bCompressSaveData(false)
+	, SaveDataCompressionFormat(NAME_Oodle)
+	, MinCompressedRecordSize(256)
+	, bParallelSaveCompression(false)
+	, MinParallelSaveRecords(64)
+	, bSaveNameTables(false)
 	, bLogOnSignalDisabled(true)
 	, bLogOnSignalPassthrough(true)
+	, MaxPinRecords(16)
+	, bQueuedExecution(false)
+	, MaxQueuedSignalsPerFrame(0)
+	, QueuedSignalsTimeBudget(0.0f)
+	, FlowTimerResolution(0.02f)
+	, MaxPooledComponents(16)
+	, MaxComponentRegistrationsPerFrame(0)
 	, bUseAdaptiveNodeTitles(false)
 	, DefaultExpectedOwnerClass(UFlowComponent::StaticClass())
 {
@@ -5,15 +5,20 @@
 #include "FlowAsset.h"
 #include "FlowComponent.h"
 #include "FlowLogChannels.h"
+#include "FlowProfiler.h"
 #include "FlowSave.h"
 #include "FlowSettings.h"
 #include "Nodes/Route/FlowNode_SubGraph.h"
+#include "Nodes/World/FlowNode_ComponentObserver.h"
 
 #include "Engine/GameInstance.h"
 #include "Engine/World.h"
 #include "Logging/MessageLog.h"
+#include "Async/ParallelFor.h"
 #include "Misc/Paths.h"
+#include "TimerManager.h"
 #include "UObject/UObjectHash.h"
+#include "UObject/UnrealType.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FlowSubsystem)
 
@@ -25,7 +30,16 @@ FNativeFlowAssetEvent UFlowSubsystem::OnInstancedTemplateRemoved;
 #define LOCTEXT_NAMESPACE "FlowSubsystem"
 
 UFlowSubsystem::UFlowSubsystem()
-	: LoadedSaveGame(nullptr)
+	: ComponentPool(nullptr)
+	, NextPendingRootFlowId(0)
+	, LoadedSaveGame(nullptr)
+	, bDeferringSerialization(false)
+	, bDeliveringSignals(false)
+	, bSignalDeliveryScheduled(false)
+	, SignalBudgetFrame(0)
+	, SignalsDeliveredThisFrame(0)
+	, SignalSecondsThisFrame(0.0)
+	, TimerWheelResolution(0.02f)
 {
 }
 
@@ -50,30 +64,53 @@ bool UFlowSubsystem::ShouldCreateSubsystem(UObject* Outer) const
 
 void UFlowSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
+	ComponentPool = NewObject<UFlowComponentPool>(this);
+	TimerWheelResolution = FMath::Max(UFlowSettings::Get()->FlowTimerResolution, UE_KINDA_SMALL_NUMBER);
 }
 
 void UFlowSubsystem::Deinitialize()
 {
 	AbortActiveFlows();
+
+	// finished nodes have released their injected components already
+	if (ComponentPool)
+	{
+		ComponentPool->Empty();
+	}
 }
 
 void UFlowSubsystem::AbortActiveFlows()
 {
 	if (InstancedTemplates.Num() > 0)
 	{
-		for (int32 i = InstancedTemplates.Num() - 1; i >= 0; i--)
+		// finishing the last instance removes template from the set
+		const TArray<UFlowAsset*> Templates = InstancedTemplates.Array();
+		for (int32 i = Templates.Num() - 1; i >= 0; i--)
 		{
-			if (InstancedTemplates.IsValidIndex(i) && InstancedTemplates[i])
+			if (Templates[i])
 			{
-				InstancedTemplates[i]->ClearInstances();
+				Templates[i]->ClearInstances();
 			}
 		}
 	}
 
 	InstancedTemplates.Empty();
 	InstancedSubFlows.Empty();
+	InstancePools.Empty();
+
+	// requests still in flight will find nothing to complete
+	PendingRootFlows.Empty();
+	PendingSubFlows.Empty();
 
 	RootInstances.Empty();
+	RootInstancesByOwner.Empty();
+	RootInstancesByTemplate.Empty();
+
+	SignalQueue.Empty();
+	SentSignals.Empty();
+
+	TimerWheel.Reset();
+	UpdateTimerWheelTicking();
 }
 
 void UFlowSubsystem::StartRootFlow(UObject* Owner, UFlowAsset* FlowAsset, const bool bAllowMultipleInstances /* = true */)
@@ -96,12 +133,15 @@ void UFlowSubsystem::StartRootFlow(UObject* Owner, UFlowAsset* FlowAsset, const
 
 UFlowAsset* UFlowSubsystem::CreateRootFlow(UObject* Owner, UFlowAsset* FlowAsset, const bool bAllowMultipleInstances)
 {
-	for (const TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	if (const TSet<UFlowAsset*>* OwnerInstances = RootInstancesByOwner.Find(Owner))
 	{
-		if (Owner == RootInstance.Value.Get() && FlowAsset == RootInstance.Key->GetTemplateAsset())
+		for (const UFlowAsset* RootInstance : *OwnerInstances)
 		{
-			UE_LOG(LogFlow, Warning, TEXT("Attempted to start Root Flow for the same Owner again. Owner: %s. Flow Asset: %s."), *Owner->GetName(), *FlowAsset->GetName());
-			return nullptr;
+			if (FlowAsset == RootInstance->GetTemplateAsset())
+			{
+				UE_LOG(LogFlow, Warning, TEXT("Attempted to start Root Flow for the same Owner again. Owner: %s. Flow Asset: %s."), *Owner->GetName(), *FlowAsset->GetName());
+				return nullptr;
+			}
 		}
 	}
 
@@ -114,48 +154,159 @@ UFlowAsset* UFlowSubsystem::CreateRootFlow(UObject* Owner, UFlowAsset* FlowAsset
 	UFlowAsset* NewFlow = CreateFlowInstance(Owner, FlowAsset);
 	if (NewFlow)
 	{
-		RootInstances.Add(NewFlow, Owner);
+		AddRootInstance(NewFlow, Owner);
 	}
 
 	return NewFlow;
 }
 
+void UFlowSubsystem::StartRootFlowAsync(UObject* Owner, const TSoftObjectPtr<UFlowAsset>& FlowAsset, const bool bAllowMultipleInstances /* = true */, const bool bLoadReferencedAssets /* = false */,
+                                        FNativeFlowAssetEvent OnStarted /* = FNativeFlowAssetEvent() */)
+{
+	if (FlowAsset.IsNull())
+	{
+#if WITH_EDITOR
+		FMessageLog("PIE").Error(LOCTEXT("StartRootFlowAsyncNullAsset", "Attempted to start Root Flow with a null asset."))
+		                  ->AddToken(FUObjectToken::Create(Owner));
+#endif
+		OnStarted.ExecuteIfBound(nullptr);
+		return;
+	}
+
+	const uint32 RequestId = NextPendingRootFlowId++;
+	const FFlowPendingRootFlow& NewPendingRootFlow = PendingRootFlows.Add(RequestId, FFlowPendingRootFlow(Owner, FlowAsset.ToSoftObjectPath()));
+
+	RequestFlowAssetsLoad({FlowAsset.ToSoftObjectPath()}, bLoadReferencedAssets, NewPendingRootFlow.LoadHandles, [this, RequestId, FlowAsset, bAllowMultipleInstances, OnStarted]()
+	{
+		UFlowAsset* NewFlow = nullptr;
+
+		FFlowPendingRootFlow PendingRootFlow(nullptr, FSoftObjectPath());
+		if (PendingRootFlows.RemoveAndCopyValue(RequestId, PendingRootFlow) && PendingRootFlow.Owner.IsValid())
+		{
+			if (UFlowAsset* LoadedFlowAsset = FlowAsset.Get())
+			{
+				NewFlow = CreateRootFlow(PendingRootFlow.Owner.Get(), LoadedFlowAsset, bAllowMultipleInstances);
+				if (NewFlow)
+				{
+					// referenced assets are used only once nodes are activated, so these stay loaded until the flow finishes
+					NewFlow->LoadHandles = MoveTemp(*PendingRootFlow.LoadHandles);
+					NewFlow->StartFlow();
+				}
+			}
+			else
+			{
+				UE_LOG(LogFlow, Warning, TEXT("Failed to load Root Flow asset %s"), *FlowAsset.ToString());
+			}
+		}
+
+		OnStarted.ExecuteIfBound(NewFlow);
+	});
+}
+
 void UFlowSubsystem::FinishRootFlow(UObject* Owner, UFlowAsset* TemplateAsset, const EFlowFinishPolicy FinishPolicy)
 {
+	if (PendingRootFlows.Num() > 0 && TemplateAsset)
+	{
+		const FSoftObjectPath TemplatePath(TemplateAsset);
+		for (TMap<uint32, FFlowPendingRootFlow>::TIterator It(PendingRootFlows); It; ++It)
+		{
+			if (It.Value().Owner == Owner && It.Value().AssetPath == TemplatePath)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
 	UFlowAsset* InstanceToFinish = nullptr;
 
-	for (TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	if (const TSet<UFlowAsset*>* OwnerInstances = Owner ? RootInstancesByOwner.Find(Owner) : nullptr)
 	{
-		if (Owner && Owner == RootInstance.Value.Get() && RootInstance.Key && RootInstance.Key->GetTemplateAsset() == TemplateAsset)
+		for (UFlowAsset* RootInstance : *OwnerInstances)
 		{
-			InstanceToFinish = RootInstance.Key;
-			break;
+			if (RootInstance && RootInstance->GetTemplateAsset() == TemplateAsset)
+			{
+				InstanceToFinish = RootInstance;
+				break;
+			}
 		}
 	}
 
 	if (InstanceToFinish)
 	{
-		RootInstances.Remove(InstanceToFinish);
+		RemoveRootInstance(InstanceToFinish);
 		InstanceToFinish->FinishFlow(FinishPolicy);
 	}
 }
 
 void UFlowSubsystem::FinishAllRootFlows(UObject* Owner, const EFlowFinishPolicy FinishPolicy)
 {
+	FinishRootFlowsForOwners({Owner}, FinishPolicy);
+}
+
+void UFlowSubsystem::FinishRootFlowsForOwners(const TArray<UObject*>& Owners, const EFlowFinishPolicy FinishPolicy)
+{
+	if (PendingRootFlows.Num() > 0)
+	{
+		for (TMap<uint32, FFlowPendingRootFlow>::TIterator It(PendingRootFlows); It; ++It)
+		{
+			if (Owners.Contains(It.Value().Owner.Get()))
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
 	TArray<UFlowAsset*> InstancesToFinish;
 
-	for (TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	for (UObject* Owner : Owners)
 	{
-		if (Owner && Owner == RootInstance.Value.Get() && RootInstance.Key)
+		if (const TSet<UFlowAsset*>* OwnerInstances = Owner ? RootInstancesByOwner.Find(Owner) : nullptr)
 		{
-			InstancesToFinish.Emplace(RootInstance.Key);
+			InstancesToFinish.Append(OwnerInstances->Array());
 		}
 	}
 
 	for (UFlowAsset* InstanceToFinish : InstancesToFinish)
 	{
-		RootInstances.Remove(InstanceToFinish);
-		InstanceToFinish->FinishFlow(FinishPolicy);
+		if (InstanceToFinish)
+		{
+			RemoveRootInstance(InstanceToFinish);
+			InstanceToFinish->FinishFlow(FinishPolicy);
+		}
+	}
+}
+
+void UFlowSubsystem::AddRootInstance(UFlowAsset* Instance, UObject* Owner)
+{
+	RootInstances.Add(Instance, Owner);
+	RootInstancesByOwner.FindOrAdd(Owner).Add(Instance);
+	RootInstancesByTemplate.FindOrAdd(Instance->GetTemplateAsset()).Add(Instance);
+}
+
+void UFlowSubsystem::RemoveRootInstance(UFlowAsset* Instance)
+{
+	TWeakObjectPtr<UObject> Owner;
+	if (!RootInstances.RemoveAndCopyValue(Instance, Owner))
+	{
+		return;
+	}
+
+	if (TSet<UFlowAsset*>* OwnerInstances = RootInstancesByOwner.Find(Owner))
+	{
+		OwnerInstances->Remove(Instance);
+		if (OwnerInstances->Num() == 0)
+		{
+			RootInstancesByOwner.Remove(Owner);
+		}
+	}
+
+	if (TSet<UFlowAsset*>* TemplateInstances = RootInstancesByTemplate.Find(Instance->GetTemplateAsset()))
+	{
+		TemplateInstances->Remove(Instance);
+		if (TemplateInstances->Num() == 0)
+		{
+			RootInstancesByTemplate.Remove(Instance->GetTemplateAsset());
+		}
 	}
 }
 
@@ -199,6 +350,9 @@ UFlowAsset* UFlowSubsystem::CreateSubFlow(UFlowNode_SubGraph* SubGraphNode, cons
 
 void UFlowSubsystem::RemoveSubFlow(UFlowNode_SubGraph* SubGraphNode, const EFlowFinishPolicy FinishPolicy)
 {
+	// node finished before its asset has been loaded
+	PendingSubFlows.Remove(SubGraphNode);
+
 	if (InstancedSubFlows.Contains(SubGraphNode))
 	{
 		UFlowAsset* AssetInstance = InstancedSubFlows[SubGraphNode];
@@ -211,211 +365,859 @@ void UFlowSubsystem::RemoveSubFlow(UFlowNode_SubGraph* SubGraphNode, const EFlow
 	}
 }
 
+void UFlowSubsystem::CreateSubFlowAsync(UFlowNode_SubGraph* SubGraphNode)
+{
+	if (InstancedSubFlows.Contains(SubGraphNode) || SubGraphNode->Asset.Get())
+	{
+		CreateSubFlow(SubGraphNode);
+		return;
+	}
+
+	if (PendingSubFlows.Contains(SubGraphNode))
+	{
+		return;
+	}
+
+	const FFlowPendingSubFlow& NewPendingSubFlow = PendingSubFlows.Add(SubGraphNode);
+
+	const TWeakObjectPtr<UFlowNode_SubGraph> WeakSubGraphNode = SubGraphNode;
+	RequestFlowAssetsLoad({SubGraphNode->Asset.ToSoftObjectPath()}, true, NewPendingSubFlow.LoadHandles, [this, WeakSubGraphNode]()
+	{
+		FFlowPendingSubFlow PendingSubFlow;
+		if (!PendingSubFlows.RemoveAndCopyValue(WeakSubGraphNode, PendingSubFlow) || !WeakSubGraphNode.IsValid())
+		{
+			return;
+		}
+
+		UFlowNode_SubGraph* SubGraphNode = WeakSubGraphNode.Get();
+		if (UFlowAsset* NewSubFlow = CreateSubFlow(SubGraphNode))
+		{
+			NewSubFlow->LoadHandles = MoveTemp(*PendingSubFlow.LoadHandles);
+
+			for (const FName& EventName : PendingSubFlow.QueuedInputs)
+			{
+				SubGraphNode->GetFlowAsset()->TriggerCustomInput_FromSubGraph(SubGraphNode, EventName);
+			}
+		}
+		else
+		{
+			UE_LOG(LogFlow, Warning, TEXT("Failed to create Sub Flow from asset %s"), *SubGraphNode->Asset.ToString());
+		}
+	});
+}
+
+bool UFlowSubsystem::QueuePendingSubFlowInput(UFlowNode_SubGraph* SubGraphNode, const FName& EventName)
+{
+	if (FFlowPendingSubFlow* PendingSubFlow = PendingSubFlows.Find(SubGraphNode))
+	{
+		PendingSubFlow->QueuedInputs.Add(EventName);
+		return true;
+	}
+
+	return false;
+}
+
+bool UFlowSubsystem::IsSubFlowPending(const UFlowNode_SubGraph* SubGraphNode) const
+{
+	return PendingSubFlows.Contains(MakeWeakObjectPtr(const_cast<UFlowNode_SubGraph*>(SubGraphNode)));
+}
+
+void UFlowSubsystem::RequestFlowAssetsLoad(const TArray<FSoftObjectPath>& AssetPaths, const bool bLoadReferencedAssets, const TSharedRef<FFlowLoadHandles> LoadHandles, TFunction<void()>&& OnLoaded)
+{
+	// delegate would be called immediately by the Streamable Manager anyway, this saves creating the handle
+	bool bAllLoaded = true;
+	for (const FSoftObjectPath& AssetPath : AssetPaths)
+	{
+		if (AssetPath.ResolveObject() == nullptr)
+		{
+			bAllLoaded = false;
+			break;
+		}
+	}
+
+	// weak, so finishing the flow before it started releases handles immediately
+	const TWeakPtr<FFlowLoadHandles> WeakLoadHandles = LoadHandles;
+
+	TFunction<void()> OnAssetsLoaded = [this, AssetPaths, bLoadReferencedAssets, WeakLoadHandles, OnLoaded = MoveTemp(OnLoaded)]() mutable
+	{
+		const TSharedPtr<FFlowLoadHandles> PinnedLoadHandles = WeakLoadHandles.Pin();
+
+		TArray<FSoftObjectPath> ReferencedAssets;
+		if (bLoadReferencedAssets && PinnedLoadHandles.IsValid())
+		{
+			for (const FSoftObjectPath& AssetPath : AssetPaths)
+			{
+				if (const UFlowAsset* LoadedFlowAsset = Cast<UFlowAsset>(AssetPath.ResolveObject()))
+				{
+					GatherReferencedAssets(LoadedFlowAsset, ReferencedAssets);
+				}
+			}
+		}
+
+		// only assets not loaded yet are gathered, so recursion stops even if Sub Graphs reference each other
+		if (ReferencedAssets.Num() > 0)
+		{
+			RequestFlowAssetsLoad(ReferencedAssets, true, PinnedLoadHandles.ToSharedRef(), MoveTemp(OnLoaded));
+		}
+		else
+		{
+			OnLoaded();
+		}
+	};
+
+	if (bAllLoaded)
+	{
+		OnAssetsLoaded();
+	}
+	else
+	{
+		LoadHandles->Add(StreamableManager.RequestAsyncLoad(AssetPaths, FStreamableDelegate::CreateWeakLambda(this, MoveTemp(OnAssetsLoaded))));
+	}
+}
+
+void UFlowSubsystem::GatherReferencedAssets(const UFlowAsset* Template, TArray<FSoftObjectPath>& OutAssetPaths)
+{
+	for (const TPair<FGuid, UFlowNode*>& Node : Template->Nodes)
+	{
+		if (Node.Value == nullptr)
+		{
+			continue;
+		}
+
+		// soft references declared directly on the node class, i.e. Sub Graph asset or Level Sequence
+		for (TFieldIterator<FSoftObjectProperty> PropIt(Node.Value->GetClass()); PropIt; ++PropIt)
+		{
+			const FSoftObjectPath AssetPath = PropIt->GetPropertyValue_InContainer(Node.Value).ToSoftObjectPath();
+			if (!AssetPath.IsNull() && AssetPath.ResolveObject() == nullptr)
+			{
+				OutAssetPaths.AddUnique(AssetPath);
+			}
+		}
+	}
+}
+
 UFlowAsset* UFlowSubsystem::CreateFlowInstance(const TWeakObjectPtr<UObject> Owner, TSoftObjectPtr<UFlowAsset> FlowAsset, FString NewInstanceName)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlowCreateInstance);
+	FLOW_TRACE_SCOPE(Flow_CreateFlowInstance);
+
 	UFlowAsset* LoadedFlowAsset = FlowAsset.LoadSynchronous();
 	if (LoadedFlowAsset == nullptr)
 	{
-		return nullptr;
+		return nullptr;
+	}
+
+	AddInstancedTemplate(LoadedFlowAsset);
+
+#if WITH_EDITOR
+	if (GetWorld()->WorldType != EWorldType::Game)
+	{
+		// Fix connections - even in packaged game if assets haven't been re-saved in the editor after changing node's definition
+		LoadedFlowAsset->HarvestNodeConnections();
+	}
+#endif
+
+	UFlowAsset* NewInstance = nullptr;
+
+	// instance restored from the SaveGame needs to keep its name, so it can't come from the pool
+	if (LoadedFlowAsset->bPoolInstances && NewInstanceName.IsEmpty())
+	{
+		NewInstance = AcquirePooledInstance(LoadedFlowAsset, Owner);
+	}
+
+	if (NewInstance == nullptr)
+	{
+		NewInstance = NewFlowInstance(LoadedFlowAsset, Owner, NewInstanceName);
+	}
+
+	LoadedFlowAsset->AddInstance(NewInstance);
+	FFlowTrace::OutputInstanceCreated(*NewInstance);
+
+	return NewInstance;
+}
+
+UFlowAsset* UFlowSubsystem::NewFlowInstance(UFlowAsset* Template, const TWeakObjectPtr<UObject> Owner, FString NewInstanceName)
+{
+	// it won't be empty, if we're restoring Flow Asset instance from the SaveGame
+	if (NewInstanceName.IsEmpty())
+	{
+		NewInstanceName = MakeUniqueObjectName(this, UFlowAsset::StaticClass(), *FPaths::GetBaseFilename(Template->GetPathName())).ToString();
+	}
+
+	UFlowAsset* NewInstance = NewObject<UFlowAsset>(this, Template->GetClass(), *NewInstanceName, RF_Transient, Template, false, nullptr);
+	NewInstance->InitializeInstance(Owner, Template);
+
+	return NewInstance;
+}
+
+UFlowAsset* UFlowSubsystem::AcquirePooledInstance(UFlowAsset* Template, const TWeakObjectPtr<UObject> Owner)
+{
+	FFlowInstancePool* Pool = InstancePools.Find(Template);
+	if (Pool == nullptr)
+	{
+		Pool = &InstancePools.Add(Template);
+		PrewarmInstancePool(Template, *Pool);
+	}
+
+	while (Pool->Instances.Num() > 0)
+	{
+		UFlowAsset* PooledInstance = Pool->Instances.Pop(EAllowShrinking::No);
+		if (IsValid(PooledInstance))
+		{
+			Pool->Hits++;
+			PooledInstance->ReinitializeInstance(Owner);
+			return PooledInstance;
+		}
+	}
+
+	Pool->Misses++;
+	return nullptr;
+}
+
+void UFlowSubsystem::ReleaseFlowInstance(UFlowAsset* Instance)
+{
+	// instance might have finished itself, i.e. by reaching the Finish node
+	// it can't stay registered, as the next owner acquiring it from the pool would share it with the previous one
+	RemoveRootInstance(Instance);
+
+	if (UFlowNode_SubGraph* SubGraphNode = Instance->NodeOwningThisAssetInstance.Get())
+	{
+		if (InstancedSubFlows.FindRef(SubGraphNode) == Instance)
+		{
+			InstancedSubFlows.Remove(SubGraphNode);
+
+			if (UFlowAsset* ParentInstance = SubGraphNode->GetFlowAsset())
+			{
+				ParentInstance->ActiveSubGraphs.Remove(SubGraphNode);
+			}
+		}
+	}
+
+	UFlowAsset* Template = Instance->GetTemplateAsset();
+	FFlowInstancePool& Pool = InstancePools.FindOrAdd(Template);
+
+	if (Pool.Instances.Num() < Template->InstancePoolSize && !Pool.Instances.Contains(Instance))
+	{
+		Instance->ResetInstance();
+		Pool.Instances.Add(Instance);
+	}
+}
+
+void UFlowSubsystem::PrewarmInstancePool(UFlowAsset* Template, FFlowInstancePool& Pool)
+{
+	const int32 PrewarmCount = FMath::Min(Template->InstancePoolPrewarmCount, Template->InstancePoolSize);
+	Pool.Instances.Reserve(Template->InstancePoolSize);
+
+	for (int32 i = 0; i < PrewarmCount; i++)
+	{
+		UFlowAsset* NewInstance = NewFlowInstance(Template, nullptr, FString());
+
+		// pooled instances are kept deinitialized, the same as instances which finished their work
+		// with lazy node instancing, nodes not instanced yet are only templates
+		for (UFlowNode* Node : NewInstance->IndexedNodes)
+		{
+			if (IsValid(Node))
+			{
+				Node->DeinitializeInstance();
+			}
+		}
+		NewInstance->ResetInstance();
+
+		Pool.Instances.Add(NewInstance);
+	}
+}
+
+void UFlowSubsystem::AddInstancedTemplate(UFlowAsset* Template)
+{
+	if (!InstancedTemplates.Contains(Template))
+	{
+		InstancedTemplates.Add(Template);
+
+#if WITH_EDITOR
+		Template->RuntimeLog = MakeShareable(new FFlowMessageLog());
+		OnInstancedTemplateAdded.ExecuteIfBound(Template);
+#endif
+	}
+}
+
+void UFlowSubsystem::RemoveInstancedTemplate(UFlowAsset* Template)
+{
+#if WITH_EDITOR
+	OnInstancedTemplateRemoved.ExecuteIfBound(Template);
+	Template->RuntimeLog.Reset();
+#endif
+
+	InstancedTemplates.Remove(Template);
+}
+
+FFlowInstancePoolStats UFlowSubsystem::GetInstancePoolStats(const UFlowAsset* TemplateAsset) const
+{
+	FFlowInstancePoolStats Stats;
+
+	if (TemplateAsset)
+	{
+		Stats.LiveInstances = TemplateAsset->GetInstancesNum();
+	}
+
+	if (const FFlowInstancePool* Pool = InstancePools.Find(const_cast<UFlowAsset*>(TemplateAsset)))
+	{
+		Stats.Hits = Pool->Hits;
+		Stats.Misses = Pool->Misses;
+		Stats.PooledInstances = Pool->Instances.Num();
+	}
+
+	return Stats;
+}
+
+FFlowComponentPoolStats UFlowSubsystem::GetComponentPoolStats(const UObject* ComponentTemplateOrClass) const
+{
+	return ComponentPool ? ComponentPool->GetStats(ComponentTemplateOrClass) : FFlowComponentPoolStats();
+}
+
+TMap<UObject*, UFlowAsset*> UFlowSubsystem::GetRootInstances() const
+{
+	TMap<UObject*, UFlowAsset*> Result;
+	for (const TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	{
+		Result.Emplace(RootInstance.Value.Get(), RootInstance.Key);
+	}
+	return Result;
+}
+
+TSet<UFlowAsset*> UFlowSubsystem::GetRootInstancesByOwner(const UObject* Owner) const
+{
+	if (const TSet<UFlowAsset*>* OwnerInstances = Owner ? RootInstancesByOwner.Find(MakeWeakObjectPtr(const_cast<UObject*>(Owner))) : nullptr)
+	{
+		return *OwnerInstances;
+	}
+	return TSet<UFlowAsset*>();
+}
+
+TSet<UFlowAsset*> UFlowSubsystem::GetRootInstancesByTemplate(const UFlowAsset* TemplateAsset) const
+{
+	if (const TSet<UFlowAsset*>* TemplateInstances = RootInstancesByTemplate.Find(TemplateAsset))
+	{
+		return *TemplateInstances;
+	}
+	return TSet<UFlowAsset*>();
+}
+
+UFlowAsset* UFlowSubsystem::GetRootFlow(const UObject* Owner) const
+{
+	const TSet<UFlowAsset*> Result = GetRootInstancesByOwner(Owner);
+	if (Result.Num() > 0)
+	{
+		return Result.Array()[0];
+	}
+
+	return nullptr;
+}
+
+UWorld* UFlowSubsystem::GetWorld() const
+{
+	return GetGameInstance()->GetWorld();
+}
+
+void UFlowSubsystem::OnGameSaved(UFlowSaveGame* SaveGame)
+{
+	// clear existing data, in case we received reused SaveGame instance
+	// we only remove data for the current world + global Flow Graph instances (i.e. not bound to any world if created by UGameInstanceSubsystem)
+	// we keep data bound to other worlds
+	if (GetWorld())
+	{
+		const FString& WorldName = GetWorld()->GetName();
+
+		SaveGame->FlowInstances.RemoveAll([&WorldName](const FFlowAssetSaveData& AssetRecord)
+		{
+			return AssetRecord.WorldName.IsEmpty() || AssetRecord.WorldName == WorldName;
+		});
+
+		SaveGame->FlowComponents.RemoveAll([&WorldName](const FFlowComponentSaveData& ComponentRecord)
+		{
+			return ComponentRecord.WorldName.IsEmpty() || ComponentRecord.WorldName == WorldName;
+		});
+	}
+
+	SaveRecords(SaveGame, nullptr);
+}
+
+void UFlowSubsystem::OnGameSavedIncremental(UFlowSaveGame* SaveGame)
+{
+	// dirty flags describe changes since the previous save, so they're meaningless for any other SaveGame
+	if (SaveGame != IncrementalSaveGame.Get() || SaveGame->SaveVersion != FFlowSaveVersion::LatestVersion || GetWorld() == nullptr)
+	{
+		OnGameSaved(SaveGame);
+		return;
+	}
+
+	// move records of the current world to the baseline, records of objects which no longer exist are dropped with it
+	FFlowSaveBaseline Baseline;
+	const FString& WorldName = GetWorld()->GetName();
+
+	SaveGame->FlowInstances.RemoveAll([&WorldName, &Baseline](FFlowAssetSaveData& AssetRecord)
+	{
+		if (AssetRecord.WorldName.IsEmpty() || AssetRecord.WorldName == WorldName)
+		{
+			const FString InstanceName = AssetRecord.InstanceName;
+			if (!Baseline.FlowInstances.Contains(InstanceName))
+			{
+				Baseline.FlowInstances.Add(InstanceName, MoveTemp(AssetRecord));
+			}
+			return true;
+		}
+		return false;
+	});
+
+	SaveGame->FlowComponents.RemoveAll([&WorldName, &Baseline](FFlowComponentSaveData& ComponentRecord)
+	{
+		if (ComponentRecord.WorldName.IsEmpty() || ComponentRecord.WorldName == WorldName)
+		{
+			const FString ActorInstanceName = ComponentRecord.ActorInstanceName;
+			if (!Baseline.FlowComponents.Contains(ActorInstanceName))
+			{
+				Baseline.FlowComponents.Add(ActorInstanceName, MoveTemp(ComponentRecord));
+			}
+			return true;
+		}
+		return false;
+	});
+
+	SaveRecords(SaveGame, &Baseline);
+}
+
+void UFlowSubsystem::SaveRecords(UFlowSaveGame* SaveGame, FFlowSaveBaseline* Baseline)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowSave);
+	FLOW_TRACE_SCOPE(Flow_SaveRecords);
+
+	SaveGame->SaveVersion = FFlowSaveVersion::LatestVersion;
+
+	// records written by this save start here
+	const int32 FirstNewInstance = SaveGame->FlowInstances.Num();
+	const int32 FirstNewComponent = SaveGame->FlowComponents.Num();
+
+	// 1st phase: call OnSave() and build records on the game thread
+	// serialization is deferred if records are compressed in parallel or share name tables
+	bDeferringSerialization = UFlowSettings::Get()->IsParallelSaveCompressionEnabled() || UFlowSettings::Get()->bSaveNameTables;
+	DeferredSerializations.Reset();
+
+	// save Flow Graphs
+	for (const TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	{
+		if (RootInstance.Key && RootInstance.Value.IsValid())
+		{
+			if (UFlowComponent* FlowComponent = Cast<UFlowComponent>(RootInstance.Value))
+			{
+				if (Baseline)
+				{
+					FlowComponent->SaveRootFlowIncremental(SaveGame->FlowInstances, *Baseline);
+				}
+				else
+				{
+					FlowComponent->SaveRootFlow(SaveGame->FlowInstances);
+				}
+			}
+			else if (Baseline)
+			{
+				RootInstance.Key->SaveInstanceIncremental(SaveGame->FlowInstances, *Baseline);
+			}
+			else
+			{
+				RootInstance.Key->SaveInstance(SaveGame->FlowInstances);
+			}
+		}
+	}
+
+	// save Flow Components
+	{
+		// retrieve all registered components
+		TArray<TWeakObjectPtr<UFlowComponent>> ComponentsArray;
+		FlowComponentRegistry.GenerateValueArray(ComponentsArray);
+
+		// ensure uniqueness of entries
+		const TSet<TWeakObjectPtr<UFlowComponent>> RegisteredComponents = TSet<TWeakObjectPtr<UFlowComponent>>(ComponentsArray);
+
+		// write archives to SaveGame
+		for (const TWeakObjectPtr<UFlowComponent> RegisteredComponent : RegisteredComponents)
+		{
+			FFlowComponentSaveData PreviousRecord;
+			const bool bHasPreviousRecord = Baseline && Baseline->FlowComponents.RemoveAndCopyValue(RegisteredComponent->GetOwner()->GetName(), PreviousRecord);
+			if (bHasPreviousRecord)
+			{
+				// previous record of the component calling OnSave() when clean is reused only if it doesn't produce different data
+				RegisteredComponent->UpdateSaveDirty();
+			}
+
+			if (bHasPreviousRecord && !RegisteredComponent->IsSaveDirty())
+			{
+				SaveGame->FlowComponents.Emplace(MoveTemp(PreviousRecord));
+			}
+			else
+			{
+				SaveGame->FlowComponents.Emplace(RegisteredComponent->SaveInstance());
+			}
+		}
+	}
+
+	bDeferringSerialization = false;
+
+	// 2nd phase: records won't move anymore, so deferred serializations can write to them
+	if (DeferredSerializations.Num() > 0)
+	{
+		for (int32 i = FirstNewInstance; i < SaveGame->FlowInstances.Num(); i++)
+		{
+			FFlowAssetSaveData& AssetRecord = SaveGame->FlowInstances[i];
+			BindDeferredSerialization(AssetRecord.PendingSerialization, AssetRecord.AssetData, AssetRecord.CompressionFormat, AssetRecord.UncompressedSize, AssetRecord.bNameTableEncoding);
+
+			for (FFlowNodeSaveData& NodeRecord : AssetRecord.NodeRecords)
+			{
+				BindDeferredSerialization(NodeRecord.PendingSerialization, NodeRecord.NodeData, NodeRecord.CompressionFormat, NodeRecord.UncompressedSize, NodeRecord.bNameTableEncoding);
+			}
+		}
+
+		for (int32 i = FirstNewComponent; i < SaveGame->FlowComponents.Num(); i++)
+		{
+			FFlowComponentSaveData& ComponentRecord = SaveGame->FlowComponents[i];
+			BindDeferredSerialization(ComponentRecord.PendingSerialization, ComponentRecord.ComponentData, ComponentRecord.CompressionFormat, ComponentRecord.UncompressedSize, ComponentRecord.bNameTableEncoding);
+		}
+
+		ExecuteDeferredSerializations(SaveGame);
+	}
+
+	SaveGame->InvalidateRecordIndex();
+	IncrementalSaveGame = SaveGame;
+}
+
+bool UFlowSubsystem::DeferSerialization(UObject* Object, int32& OutPendingSerialization)
+{
+	if (!bDeferringSerialization)
+	{
+		return false;
+	}
+
+	OutPendingSerialization = DeferredSerializations.Emplace(Object);
+	return true;
+}
+
+void UFlowSubsystem::BindDeferredSerialization(int32& PendingSerialization, TArray<uint8>& Data, FName& CompressionFormat, int32& UncompressedSize, bool& bNameTableEncoding)
+{
+	if (DeferredSerializations.IsValidIndex(PendingSerialization))
+	{
+		FFlowDeferredSerialization& Serialization = DeferredSerializations[PendingSerialization];
+		Serialization.Data = &Data;
+		Serialization.CompressionFormat = &CompressionFormat;
+		Serialization.UncompressedSize = &UncompressedSize;
+		Serialization.bNameTableEncoding = &bNameTableEncoding;
+	}
+
+	PendingSerialization = INDEX_NONE;
+}
+
+void UFlowSubsystem::ExecuteDeferredSerializations(UFlowSaveGame* SaveGame)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	const UFlowSettings* Settings = UFlowSettings::Get();
+	const bool bNameTables = Settings->bSaveNameTables;
+	const EParallelForFlags ParallelForFlags = (Settings->IsParallelSaveCompressionEnabled() && DeferredSerializations.Num() >= Settings->MinParallelSaveRecords)
+		                                           ? EParallelForFlags::None
+		                                           : EParallelForFlags::ForceSingleThread;
+
+	// objects are serialized on the game thread, as Serialize() might access state owned by it
+	FFlowRecordTables Tables;
+	for (const FFlowDeferredSerialization& Serialization : DeferredSerializations)
+	{
+		if (Serialization.Data)
+		{
+			*Serialization.bNameTableEncoding = bNameTables;
+
+			if (bNameTables)
+			{
+				FFlowSaveSerialization::SerializeObjectWithTables(Serialization.Object, *Serialization.Data, Tables);
+
+				// table indices are assigned in the order of records, same as in the serial save
+				SaveGame->MergeRecordTables(Tables, *Serialization.Data);
+			}
+			else
+			{
+				FFlowSaveSerialization::SerializeObjectUncompressed(Serialization.Object, *Serialization.Data);
+			}
+		}
+	}
+
+	// only compression of already serialized data runs on worker threads
+	ParallelFor(DeferredSerializations.Num(), [this](const int32 Index)
+	{
+		const FFlowDeferredSerialization& Serialization = DeferredSerializations[Index];
+		if (Serialization.Data)
+		{
+			FFlowSaveCompression::Compress(*Serialization.Data, *Serialization.CompressionFormat, *Serialization.UncompressedSize);
+		}
+	}, ParallelForFlags);
+
+	for (const FFlowDeferredSerialization& Serialization : DeferredSerializations)
+	{
+		if (Serialization.Data == nullptr)
+		{
+			UE_LOG(LogFlow, Warning, TEXT("Save record of %s hasn't been written to the SaveGame, its data is missing"), *GetNameSafe(Serialization.Object));
+		}
+	}
+
+	UE_LOG(LogFlow, Verbose, TEXT("Serialized %d Flow save records in %.2f ms"), DeferredSerializations.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	DeferredSerializations.Reset();
+}
+
+void UFlowSubsystem::OnGameLoaded(UFlowSaveGame* SaveGame)
+{
+	LoadedSaveGame = SaveGame;
+
+	// here's opportunity to apply loaded data to custom systems
+	// it's recommended to do this by overriding method in the subclass
+}
+
+void UFlowSubsystem::LoadRootFlow(UObject* Owner, UFlowAsset* FlowAsset, const FString& SavedAssetInstanceName)
+{
+	if (FlowAsset == nullptr || SavedAssetInstanceName.IsEmpty())
+	{
+		return;
 	}
 
-	AddInstancedTemplate(LoadedFlowAsset);
+	// assets not bound to the world are saved without the world name
+	const FString WorldName = FlowAsset->IsBoundToWorld() ? GetWorld()->GetName() : FString();
 
-#if WITH_EDITOR
-	if (GetWorld()->WorldType != EWorldType::Game)
+	if (const FFlowAssetSaveData* AssetRecord = LoadedSaveGame->FindFlowInstance(WorldName, SavedAssetInstanceName))
 	{
-		// Fix connections - even in packaged game if assets haven't been re-saved in the editor after changing node's definition
-		LoadedFlowAsset->HarvestNodeConnections();
+		UFlowAsset* LoadedInstance = CreateRootFlow(Owner, FlowAsset, false);
+		if (LoadedInstance)
+		{
+			LoadedInstance->LoadInstance(*AssetRecord);
+		}
 	}
-#endif
+}
 
-	// it won't be empty, if we're restoring Flow Asset instance from the SaveGame
-	if (NewInstanceName.IsEmpty())
+void UFlowSubsystem::LoadSubFlow(UFlowNode_SubGraph* SubGraphNode, const FString& SavedAssetInstanceName)
+{
+	if (SubGraphNode->Asset.IsNull())
 	{
-		NewInstanceName = MakeUniqueObjectName(this, UFlowAsset::StaticClass(), *FPaths::GetBaseFilename(LoadedFlowAsset->GetPathName())).ToString();
+		return;
 	}
 
-	UFlowAsset* NewInstance = NewObject<UFlowAsset>(this, LoadedFlowAsset->GetClass(), *NewInstanceName, RF_Transient, LoadedFlowAsset, false, nullptr);
-	NewInstance->InitializeInstance(Owner, LoadedFlowAsset);
-
-	LoadedFlowAsset->AddInstance(NewInstance);
+	UFlowAsset* SubGraphAsset = SubGraphNode->Asset.LoadSynchronous();
 
-	return NewInstance;
-}
+	// assets not bound to the world are saved without the world name
+	const FString WorldName = (SubGraphAsset && SubGraphAsset->IsBoundToWorld() == false) ? FString() : GetWorld()->GetName();
 
-void UFlowSubsystem::AddInstancedTemplate(UFlowAsset* Template)
-{
-	if (!InstancedTemplates.Contains(Template))
+	if (const FFlowAssetSaveData* AssetRecord = LoadedSaveGame->FindFlowInstance(WorldName, SavedAssetInstanceName))
 	{
-		InstancedTemplates.Add(Template);
-
-#if WITH_EDITOR
-		Template->RuntimeLog = MakeShareable(new FFlowMessageLog());
-		OnInstancedTemplateAdded.ExecuteIfBound(Template);
-#endif
+		UFlowAsset* LoadedInstance = CreateSubFlow(SubGraphNode, SavedAssetInstanceName);
+		if (LoadedInstance)
+		{
+			LoadedInstance->LoadInstance(*AssetRecord);
+		}
 	}
 }
 
-void UFlowSubsystem::RemoveInstancedTemplate(UFlowAsset* Template)
+void UFlowSubsystem::QueueSignal(UFlowAsset* FlowInstance, UFlowNode* Node, const uint16 InputPinIndex)
 {
-#if WITH_EDITOR
-	OnInstancedTemplateRemoved.ExecuteIfBound(Template);
-	Template->RuntimeLog.Reset();
-#endif
+	if (bDeliveringSignals)
+	{
+		// signal sent by the node being executed right now
+		SentSignals.Emplace(FlowInstance, Node, InputPinIndex);
+		return;
+	}
 
-	InstancedTemplates.Remove(Template);
-}
+	SignalQueue.Emplace(FlowInstance, Node, InputPinIndex);
 
-TMap<UObject*, UFlowAsset*> UFlowSubsystem::GetRootInstances() const
-{
-	TMap<UObject*, UFlowAsset*> Result;
-	for (const TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	// if the budget has been already exceeded, signal will be delivered in the next frame
+	if (!bSignalDeliveryScheduled)
 	{
-		Result.Emplace(RootInstance.Value.Get(), RootInstance.Key);
+		DeliverQueuedSignals();
 	}
-	return Result;
 }
 
-TSet<UFlowAsset*> UFlowSubsystem::GetRootInstancesByOwner(const UObject* Owner) const
+void UFlowSubsystem::DiscardQueuedSignals(const UFlowAsset* FlowInstance)
 {
-	TSet<UFlowAsset*> Result;
-	for (const TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
+	if (SignalQueue.Num() > 0)
 	{
-		if (Owner && RootInstance.Value == Owner)
+		TRingBuffer<FFlowQueuedSignal> RemainingSignals;
+		for (int32 i = 0; i < SignalQueue.Num(); i++)
 		{
-			Result.Emplace(RootInstance.Key);
+			if (SignalQueue[i].FlowInstance.Get() != FlowInstance)
+			{
+				RemainingSignals.Add(SignalQueue[i]);
+			}
 		}
+		SignalQueue = MoveTemp(RemainingSignals);
 	}
-	return Result;
+
+	SentSignals.RemoveAll([FlowInstance](const FFlowQueuedSignal& Signal)
+	{
+		return Signal.FlowInstance.Get() == FlowInstance;
+	});
 }
 
-UFlowAsset* UFlowSubsystem::GetRootFlow(const UObject* Owner) const
+void UFlowSubsystem::DeliverQueuedSignals()
 {
-	const TSet<UFlowAsset*> Result = GetRootInstancesByOwner(Owner);
-	if (Result.Num() > 0)
+	bSignalDeliveryScheduled = false;
+
+	if (bDeliveringSignals)
 	{
-		return Result.Array()[0];
+		return;
 	}
 
-	return nullptr;
-}
-
-UWorld* UFlowSubsystem::GetWorld() const
-{
-	return GetGameInstance()->GetWorld();
-}
+	TGuardValue<bool> DeliveringGuard(bDeliveringSignals, true);
 
-void UFlowSubsystem::OnGameSaved(UFlowSaveGame* SaveGame)
-{
-	// clear existing data, in case we received reused SaveGame instance
-	// we only remove data for the current world + global Flow Graph instances (i.e. not bound to any world if created by UGameInstanceSubsystem)
-	// we keep data bound to other worlds
-	if (GetWorld())
+	if (SignalBudgetFrame != GFrameCounter)
 	{
-		const FString& WorldName = GetWorld()->GetName();
+		SignalBudgetFrame = GFrameCounter;
+		SignalsDeliveredThisFrame = 0;
+		SignalSecondsThisFrame = 0.0;
+	}
 
-		for (int32 i = SaveGame->FlowInstances.Num() - 1; i >= 0; i--)
+	while (SignalQueue.Num() > 0)
+	{
+		if (IsSignalBudgetExceeded())
 		{
-			if (SaveGame->FlowInstances[i].WorldName.IsEmpty() || SaveGame->FlowInstances[i].WorldName == WorldName)
+			// continue in the next frame
+			if (UWorld* World = GetWorld())
 			{
-				SaveGame->FlowInstances.RemoveAt(i);
+				World->GetTimerManager().SetTimerForNextTick(this, &UFlowSubsystem::DeliverQueuedSignals);
+				bSignalDeliveryScheduled = true;
+				break;
 			}
 		}
 
-		for (int32 i = SaveGame->FlowComponents.Num() - 1; i >= 0; i--)
+		const FFlowQueuedSignal Signal = SignalQueue.PopFrontValue();
+		const double StartTime = FPlatformTime::Seconds();
+
+		if (UFlowAsset* FlowInstance = Signal.FlowInstance.Get())
 		{
-			if (SaveGame->FlowComponents[i].WorldName.IsEmpty() || SaveGame->FlowComponents[i].WorldName == WorldName)
-			{
-				SaveGame->FlowComponents.RemoveAt(i);
-			}
+			FlowInstance->ExecuteTriggerInput(Signal.Node, Signal.InputPinIndex);
 		}
-	}
 
-	// save Flow Graphs
-	for (const TPair<UFlowAsset*, TWeakObjectPtr<UObject>>& RootInstance : RootInstances)
-	{
-		if (RootInstance.Key && RootInstance.Value.IsValid())
+		SignalSecondsThisFrame += FPlatformTime::Seconds() - StartTime;
+		SignalsDeliveredThisFrame++;
+
+		// signals sent by the executed node are delivered before anything queued earlier, in the order they were sent
+		for (int32 i = SentSignals.Num() - 1; i >= 0; i--)
 		{
-			if (UFlowComponent* FlowComponent = Cast<UFlowComponent>(RootInstance.Value))
-			{
-				FlowComponent->SaveRootFlow(SaveGame->FlowInstances);
-			}
-			else
-			{
-				RootInstance.Key->SaveInstance(SaveGame->FlowInstances);
-			}
+			SignalQueue.AddFront(SentSignals[i]);
 		}
+		SentSignals.Reset();
 	}
+}
 
-	// save Flow Components
+bool UFlowSubsystem::IsSignalBudgetExceeded() const
+{
+	const UFlowSettings* Settings = UFlowSettings::Get();
+
+	if (Settings->MaxQueuedSignalsPerFrame > 0 && SignalsDeliveredThisFrame >= Settings->MaxQueuedSignalsPerFrame)
 	{
-		// retrieve all registered components
-		TArray<TWeakObjectPtr<UFlowComponent>> ComponentsArray;
-		FlowComponentRegistry.GenerateValueArray(ComponentsArray);
+		return true;
+	}
 
-		// ensure uniqueness of entries
-		const TSet<TWeakObjectPtr<UFlowComponent>> RegisteredComponents = TSet<TWeakObjectPtr<UFlowComponent>>(ComponentsArray);
+	if (Settings->QueuedSignalsTimeBudget > 0.0f && SignalSecondsThisFrame * 1000.0 >= Settings->QueuedSignalsTimeBudget)
+	{
+		return true;
+	}
 
-		// write archives to SaveGame
-		for (const TWeakObjectPtr<UFlowComponent> RegisteredComponent : RegisteredComponents)
-		{
-			SaveGame->FlowComponents.Emplace(RegisteredComponent->SaveInstance());
-		}
+	return false;
+}
+
+FFlowTimerHandle UFlowSubsystem::SetFlowTimer(const UFlowNodeBase* Node, FFlowTimerDelegate Delegate, const float Delay, const float Interval /* = 0.0f */)
+{
+	if (GetWorld() == nullptr || Node == nullptr)
+	{
+		return FFlowTimerHandle();
+	}
+
+	UFlowAsset* RootFlow = Node->GetFlowAsset();
+	while (RootFlow && RootFlow->GetParentInstance())
+	{
+		RootFlow = RootFlow->GetParentInstance();
 	}
+
+	// tolerance prevents adding a tick if Delay is a multiple of the resolution
+	const uint32 DelayTicks = static_cast<uint32>(FMath::CeilToInt64(Delay / TimerWheelResolution - UE_KINDA_SMALL_NUMBER));
+	const uint32 IntervalTicks = Interval > 0.0f ? FMath::Max<uint32>(static_cast<uint32>(FMath::CeilToInt64(Interval / TimerWheelResolution - UE_KINDA_SMALL_NUMBER)), 1) : 0;
+
+	const FFlowTimerHandle Handle = TimerWheel.SetTimer(MoveTemp(Delegate), DelayTicks, IntervalTicks, RootFlow, RootFlow && RootFlow->bFlowTimersPaused);
+	UpdateTimerWheelTicking();
+	return Handle;
 }
 
-void UFlowSubsystem::OnGameLoaded(UFlowSaveGame* SaveGame)
+void UFlowSubsystem::ClearFlowTimer(FFlowTimerHandle& Handle)
 {
-	LoadedSaveGame = SaveGame;
+	TimerWheel.ClearTimer(Handle);
+	UpdateTimerWheelTicking();
+}
 
-	// here's opportunity to apply loaded data to custom systems
-	// it's recommended to do this by overriding method in the subclass
+bool UFlowSubsystem::IsFlowTimerActive(const FFlowTimerHandle& Handle) const
+{
+	return TimerWheel.IsTimerActive(Handle);
 }
 
-void UFlowSubsystem::LoadRootFlow(UObject* Owner, UFlowAsset* FlowAsset, const FString& SavedAssetInstanceName)
+float UFlowSubsystem::GetFlowTimerRemaining(const FFlowTimerHandle& Handle) const
 {
-	if (FlowAsset == nullptr || SavedAssetInstanceName.IsEmpty())
+	return TimerWheel.GetTicksRemaining(Handle) * TimerWheelResolution;
+}
+
+void UFlowSubsystem::PauseFlowTimers(UFlowAsset* RootFlow)
+{
+	if (RootFlow && !RootFlow->bFlowTimersPaused)
 	{
-		return;
+		RootFlow->bFlowTimersPaused = true;
+		RootFlow->MarkSaveDirty();
+
+		TimerWheel.SetPaused(RootFlow, true);
+		UpdateTimerWheelTicking();
 	}
+}
 
-	for (const FFlowAssetSaveData& AssetRecord : LoadedSaveGame->FlowInstances)
+void UFlowSubsystem::UnpauseFlowTimers(UFlowAsset* RootFlow)
+{
+	if (RootFlow && RootFlow->bFlowTimersPaused)
 	{
-		if (AssetRecord.InstanceName == SavedAssetInstanceName
-			&& (FlowAsset->IsBoundToWorld() == false || AssetRecord.WorldName == GetWorld()->GetName()))
-		{
-			UFlowAsset* LoadedInstance = CreateRootFlow(Owner, FlowAsset, false);
-			if (LoadedInstance)
-			{
-				LoadedInstance->LoadInstance(AssetRecord);
-			}
-			return;
-		}
+		RootFlow->bFlowTimersPaused = false;
+		RootFlow->MarkSaveDirty();
+
+		TimerWheel.SetPaused(RootFlow, false);
+		UpdateTimerWheelTicking();
 	}
 }
 
-void UFlowSubsystem::LoadSubFlow(UFlowNode_SubGraph* SubGraphNode, const FString& SavedAssetInstanceName)
+bool UFlowSubsystem::AreFlowTimersPaused(const UFlowAsset* RootFlow) const
 {
-	if (SubGraphNode->Asset.IsNull())
+	return RootFlow && RootFlow->bFlowTimersPaused;
+}
+
+void UFlowSubsystem::TickTimerWheel()
+{
+	TimerWheel.Tick();
+	UpdateTimerWheelTicking();
+}
+
+void UFlowSubsystem::UpdateTimerWheelTicking()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
 	{
 		return;
 	}
 
-	UFlowAsset* SubGraphAsset = SubGraphNode->Asset.LoadSynchronous();
-
-	for (const FFlowAssetSaveData& AssetRecord : LoadedSaveGame->FlowInstances)
+	// single looping timer drives all Flow Timers, world timer manager calls it once per elapsed tick
+	FTimerManager& TimerManager = World->GetTimerManager();
+	if (TimerWheel.NumScheduled() > 0)
 	{
-		if (AssetRecord.InstanceName == SavedAssetInstanceName
-			&& ((SubGraphAsset && SubGraphAsset->IsBoundToWorld() == false) || AssetRecord.WorldName == GetWorld()->GetName()))
+		if (!TimerManager.TimerExists(TimerWheelTickHandle))
 		{
-			UFlowAsset* LoadedInstance = CreateSubFlow(SubGraphNode, SavedAssetInstanceName);
-			if (LoadedInstance)
-			{
-				LoadedInstance->LoadInstance(AssetRecord);
-			}
-			return;
+			TimerManager.SetTimer(TimerWheelTickHandle, this, &UFlowSubsystem::TickTimerWheel, TimerWheelResolution, true);
 		}
 	}
+	else if (TimerWheelTickHandle.IsValid())
+	{
+		TimerManager.ClearTimer(TimerWheelTickHandle);
+	}
 }
 
 void UFlowSubsystem::RegisterComponent(UFlowComponent* Component)
@@ -425,24 +1227,39 @@ void UFlowSubsystem::RegisterComponent(UFlowComponent* Component)
 		if (Tag.IsValid())
 		{
 			FlowComponentRegistry.Emplace(Tag, Component);
+			AddToTagIndex(Component, Tag);
 		}
 	}
 
 	OnComponentRegistered.Broadcast(Component);
+	NotifyObservers(Component, FGameplayTagContainer::EmptyContainer, [Component](UFlowNode_ComponentObserver* Observer)
+	{
+		Observer->OnComponentRegistered(Component);
+	});
 }
 
 void UFlowSubsystem::OnIdentityTagAdded(UFlowComponent* Component, const FGameplayTag& AddedTag)
 {
 	FlowComponentRegistry.Emplace(AddedTag, Component);
+	AddToTagIndex(Component, AddedTag);
 
 	// broadcast OnComponentRegistered only if this component wasn't present in the registry previously
+	const FGameplayTagContainer AddedTags(AddedTag);
 	if (Component->IdentityTags.Num() > 1)
 	{
-		OnComponentTagAdded.Broadcast(Component, FGameplayTagContainer(AddedTag));
+		OnComponentTagAdded.Broadcast(Component, AddedTags);
+		NotifyObservers(Component, AddedTags, [Component, &AddedTags](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentTagAdded(Component, AddedTags);
+		});
 	}
 	else
 	{
 		OnComponentRegistered.Broadcast(Component);
+		NotifyObservers(Component, AddedTags, [Component](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentRegistered(Component);
+		});
 	}
 }
 
@@ -451,16 +1268,25 @@ void UFlowSubsystem::OnIdentityTagsAdded(UFlowComponent* Component, const FGamep
 	for (const FGameplayTag& Tag : AddedTags)
 	{
 		FlowComponentRegistry.Emplace(Tag, Component);
+		AddToTagIndex(Component, Tag);
 	}
 
 	// broadcast OnComponentRegistered only if this component wasn't present in the registry previously
 	if (Component->IdentityTags.Num() > AddedTags.Num())
 	{
 		OnComponentTagAdded.Broadcast(Component, AddedTags);
+		NotifyObservers(Component, AddedTags, [Component, &AddedTags](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentTagAdded(Component, AddedTags);
+		});
 	}
 	else
 	{
 		OnComponentRegistered.Broadcast(Component);
+		NotifyObservers(Component, AddedTags, [Component](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentRegistered(Component);
+		});
 	}
 }
 
@@ -471,24 +1297,39 @@ void UFlowSubsystem::UnregisterComponent(UFlowComponent* Component)
 		if (Tag.IsValid())
 		{
 			FlowComponentRegistry.Remove(Tag, Component);
+			RemoveFromTagIndex(Component, Tag);
 		}
 	}
 
 	OnComponentUnregistered.Broadcast(Component);
+	NotifyObservers(Component, FGameplayTagContainer::EmptyContainer, [Component](UFlowNode_ComponentObserver* Observer)
+	{
+		Observer->OnComponentUnregistered(Component);
+	});
 }
 
 void UFlowSubsystem::OnIdentityTagRemoved(UFlowComponent* Component, const FGameplayTag& RemovedTag)
 {
 	FlowComponentRegistry.Remove(RemovedTag, Component);
+	RemoveFromTagIndex(Component, RemovedTag);
 
 	// broadcast OnComponentUnregistered only if this component isn't present in the registry anymore
+	const FGameplayTagContainer RemovedTags(RemovedTag);
 	if (Component->IdentityTags.Num() > 0)
 	{
-		OnComponentTagRemoved.Broadcast(Component, FGameplayTagContainer(RemovedTag));
+		OnComponentTagRemoved.Broadcast(Component, RemovedTags);
+		NotifyObservers(Component, RemovedTags, [Component, &RemovedTags](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentTagRemoved(Component, RemovedTags);
+		});
 	}
 	else
 	{
 		OnComponentUnregistered.Broadcast(Component);
+		NotifyObservers(Component, RemovedTags, [Component](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentUnregistered(Component);
+		});
 	}
 }
 
@@ -497,16 +1338,118 @@ void UFlowSubsystem::OnIdentityTagsRemoved(UFlowComponent* Component, const FGam
 	for (const FGameplayTag& Tag : RemovedTags)
 	{
 		FlowComponentRegistry.Remove(Tag, Component);
+		RemoveFromTagIndex(Component, Tag);
 	}
 
 	// broadcast OnComponentUnregistered only if this component isn't present in the registry anymore
 	if (Component->IdentityTags.Num() > 0)
 	{
 		OnComponentTagRemoved.Broadcast(Component, RemovedTags);
+		NotifyObservers(Component, RemovedTags, [Component, &RemovedTags](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentTagRemoved(Component, RemovedTags);
+		});
 	}
 	else
 	{
 		OnComponentUnregistered.Broadcast(Component);
+		NotifyObservers(Component, RemovedTags, [Component](UFlowNode_ComponentObserver* Observer)
+		{
+			Observer->OnComponentUnregistered(Component);
+		});
+	}
+}
+
+void UFlowSubsystem::AddToTagIndex(UFlowComponent* Component, const FGameplayTag& Tag)
+{
+	for (FGameplayTag IndexedTag = Tag; IndexedTag.IsValid(); IndexedTag = IndexedTag.RequestDirectParent())
+	{
+		++FlowComponentTagIndex.FindOrAdd(IndexedTag).FindOrAdd(Component, 0);
+	}
+}
+
+void UFlowSubsystem::RemoveFromTagIndex(UFlowComponent* Component, const FGameplayTag& Tag)
+{
+	for (FGameplayTag IndexedTag = Tag; IndexedTag.IsValid(); IndexedTag = IndexedTag.RequestDirectParent())
+	{
+		if (TMap<TWeakObjectPtr<UFlowComponent>, int32>* Bucket = FlowComponentTagIndex.Find(IndexedTag))
+		{
+			int32* MatchingTagsNum = Bucket->Find(Component);
+			if (MatchingTagsNum && --(*MatchingTagsNum) <= 0)
+			{
+				Bucket->Remove(Component);
+				if (Bucket->Num() == 0)
+				{
+					FlowComponentTagIndex.Remove(IndexedTag);
+				}
+			}
+		}
+	}
+}
+
+void UFlowSubsystem::SubscribeObserver(UFlowNode_ComponentObserver* Observer, const FGameplayTagContainer& IdentityTags)
+{
+	if (ObserverSubscriptions.Contains(Observer))
+	{
+		return;
+	}
+
+	ObserverSubscriptions.Add(Observer, IdentityTags);
+	for (const FGameplayTag& Tag : IdentityTags)
+	{
+		ObserversByTag.Emplace(Tag, Observer);
+	}
+}
+
+void UFlowSubsystem::UnsubscribeObserver(UFlowNode_ComponentObserver* Observer)
+{
+	FGameplayTagContainer IdentityTags;
+	if (ObserverSubscriptions.RemoveAndCopyValue(Observer, IdentityTags))
+	{
+		for (const FGameplayTag& Tag : IdentityTags)
+		{
+			ObserversByTag.RemoveSingle(Tag, Observer);
+		}
+	}
+}
+
+void UFlowSubsystem::NotifyObservers(UFlowComponent* Component, const FGameplayTagContainer& EventTags, TFunctionRef<void(UFlowNode_ComponentObserver*)> Notify)
+{
+	if (ObserverSubscriptions.Num() == 0)
+	{
+		return;
+	}
+
+	// observer subscribed to a parent tag might match component with a child tag, so we walk up the tag hierarchy
+	// exact matching is verified later by the observer itself
+	TArray<UFlowNode_ComponentObserver*, TInlineAllocator<16>> Observers;
+	auto CollectObservers = [this, &Observers](const FGameplayTagContainer& Tags)
+	{
+		for (const FGameplayTag& Tag : Tags)
+		{
+			for (FGameplayTag ObservedTag = Tag; ObservedTag.IsValid(); ObservedTag = ObservedTag.RequestDirectParent())
+			{
+				for (TMultiMap<FGameplayTag, TWeakObjectPtr<UFlowNode_ComponentObserver>>::TConstKeyIterator It(ObserversByTag, ObservedTag); It; ++It)
+				{
+					if (UFlowNode_ComponentObserver* Observer = It.Value().Get())
+					{
+						Observers.AddUnique(Observer);
+					}
+				}
+			}
+		}
+	};
+
+	CollectObservers(Component->IdentityTags);
+	CollectObservers(EventTags);
+
+	for (UFlowNode_ComponentObserver* Observer : Observers)
+	{
+		// observer might have been unsubscribed as the result of notifying previous observers
+		if (IsValid(Observer) && ObserverSubscriptions.Contains(Observer))
+		{
+			Notify(Observer);
+		}
 	}
 }
 
@@ -612,53 +1555,113 @@ TMap<AActor*, UFlowComponent*> UFlowSubsystem::GetFlowActorsAndComponentsByTags(
 	return Result;
 }
 
-void UFlowSubsystem::FindComponents(const FGameplayTag& Tag, const bool bExactMatch, TArray<TWeakObjectPtr<UFlowComponent>>& OutComponents) const
+void UFlowSubsystem::ForEachComponent(const FGameplayTag& Tag, const bool bExactMatch, TFunctionRef<void(UFlowComponent*)> Visitor) const
 {
 	if (bExactMatch)
 	{
-		FlowComponentRegistry.MultiFind(Tag, OutComponents);
+		for (TMultiMap<FGameplayTag, TWeakObjectPtr<UFlowComponent>>::TConstKeyIterator It(FlowComponentRegistry, Tag); It; ++It)
+		{
+			if (UFlowComponent* Component = It.Value().Get())
+			{
+				Visitor(Component);
+			}
+		}
 	}
-	else
+	else if (const TMap<TWeakObjectPtr<UFlowComponent>, int32>* Bucket = FlowComponentTagIndex.Find(Tag))
 	{
-		for (TMultiMap<FGameplayTag, TWeakObjectPtr<UFlowComponent>>::TConstIterator It(FlowComponentRegistry); It; ++It)
+		for (const TPair<TWeakObjectPtr<UFlowComponent>, int32>& Entry : *Bucket)
 		{
-			if (It.Key().MatchesTag(Tag))
+			if (UFlowComponent* Component = Entry.Key.Get())
 			{
-				OutComponents.Emplace(It.Value());
+				Visitor(Component);
 			}
 		}
 	}
 }
 
-void UFlowSubsystem::FindComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch, TSet<TWeakObjectPtr<UFlowComponent>>& OutComponents) const
+void UFlowSubsystem::ForEachComponent(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch, TFunctionRef<void(UFlowComponent*)> Visitor) const
 {
+	if (Tags.IsEmpty())
+	{
+		return;
+	}
+
 	if (MatchType == EGameplayContainerMatchType::Any)
 	{
-		for (const FGameplayTag& Tag : Tags)
+		for (int32 TagIndex = 0; TagIndex < Tags.Num(); TagIndex++)
 		{
-			TArray<TWeakObjectPtr<UFlowComponent>> ComponentsPerTag;
-			FindComponents(Tag, bExactMatch, ComponentsPerTag);
-			OutComponents.Append(ComponentsPerTag);
+			ForEachComponent(Tags.GetByIndex(TagIndex), bExactMatch, [&](UFlowComponent* Component)
+			{
+				// skip component if it has been already visited while checking previous tags
+				for (int32 PreviousIndex = 0; PreviousIndex < TagIndex; PreviousIndex++)
+				{
+					if (IsComponentIdentifiedBy(Component, Tags.GetByIndex(PreviousIndex), bExactMatch))
+					{
+						return;
+					}
+				}
+
+				Visitor(Component);
+			});
 		}
 	}
 	else // EGameplayContainerMatchType::All
 	{
-		TSet<TWeakObjectPtr<UFlowComponent>> ComponentsWithAnyTag;
+		// intersect starting from the tag with the smallest number of components
+		// bucket of the tag index contains all components found in the exact bucket, so it's used to estimate both cases
+		const FGameplayTag* SmallestBucketTag = nullptr;
+		int32 SmallestBucketNum = MAX_int32;
 		for (const FGameplayTag& Tag : Tags)
 		{
-			TArray<TWeakObjectPtr<UFlowComponent>> ComponentsPerTag;
-			FindComponents(Tag, bExactMatch, ComponentsPerTag);
-			ComponentsWithAnyTag.Append(ComponentsPerTag);
+			const int32 BucketNum = GetTagIndexBucketNum(Tag);
+			if (BucketNum < SmallestBucketNum)
+			{
+				SmallestBucketTag = &Tag;
+				SmallestBucketNum = BucketNum;
+			}
+		}
+
+		if (SmallestBucketNum == 0)
+		{
+			return;
 		}
 
-		for (const TWeakObjectPtr<UFlowComponent>& Component : ComponentsWithAnyTag)
+		// bExactMatch only selects candidates, all tags have to match exactly as in the original FindComponents
+		ForEachComponent(*SmallestBucketTag, bExactMatch, [&](UFlowComponent* Component)
 		{
-			if (Component.IsValid() && Component->IdentityTags.HasAllExact(Tags))
+			if (Component->IdentityTags.HasAllExact(Tags))
 			{
-				OutComponents.Emplace(Component);
+				Visitor(Component);
 			}
-		}
+		});
 	}
 }
 
+void UFlowSubsystem::FindComponents(const FGameplayTag& Tag, const bool bExactMatch, TArray<TWeakObjectPtr<UFlowComponent>>& OutComponents) const
+{
+	ForEachComponent(Tag, bExactMatch, [&OutComponents](UFlowComponent* Component)
+	{
+		OutComponents.Emplace(Component);
+	});
+}
+
+void UFlowSubsystem::FindComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch, TSet<TWeakObjectPtr<UFlowComponent>>& OutComponents) const
+{
+	ForEachComponent(Tags, MatchType, bExactMatch, [&OutComponents](UFlowComponent* Component)
+	{
+		OutComponents.Emplace(Component);
+	});
+}
+
+bool UFlowSubsystem::IsComponentIdentifiedBy(const UFlowComponent* Component, const FGameplayTag& Tag, const bool bExactMatch) const
+{
+	return bExactMatch ? Component->IdentityTags.HasTagExact(Tag) : Component->IdentityTags.HasTag(Tag);
+}
+
+int32 UFlowSubsystem::GetTagIndexBucketNum(const FGameplayTag& Tag) const
+{
+	const TMap<TWeakObjectPtr<UFlowComponent>, int32>* Bucket = FlowComponentTagIndex.Find(Tag);
+	return Bucket ? Bucket->Num() : 0;
+}
+
 #undef LOCTEXT_NAMESPACE
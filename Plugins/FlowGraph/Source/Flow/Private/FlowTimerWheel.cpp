@@ -0,0 +1,258 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "FlowTimerWheel.h"
+#include "FlowAsset.h"
+
+FFlowTimerWheel::FFlowTimerWheel()
+	: CurrentTick(0)
+	, ActiveTimersNum(0)
+	, PausedTimersNum(0)
+{
+}
+
+FFlowTimerHandle FFlowTimerWheel::SetTimer(FFlowTimerDelegate&& Delegate, const uint32 DelayTicks, const uint32 IntervalTicks, UFlowAsset* RootFlow, const bool bPaused)
+{
+	const int32 Index = FreeTimers.Num() > 0 ? FreeTimers.Pop(EAllowShrinking::No) : Timers.AddDefaulted();
+
+	FTimer& Timer = Timers[Index];
+	Timer.Delegate = MoveTemp(Delegate);
+	Timer.RootFlow = RootFlow;
+	Timer.IntervalTicks = IntervalTicks;
+	Timer.bActive = true;
+	Timer.bPaused = bPaused;
+	ActiveTimersNum++;
+
+	// timer set while calling delegates of the current tick can't be due in the same tick
+	const uint32 Delay = FMath::Max<uint32>(DelayTicks, 1);
+	if (bPaused)
+	{
+		Timer.PausedTicksRemaining = Delay;
+		PausedTimersNum++;
+	}
+	else
+	{
+		Timer.DueTick = CurrentTick + Delay;
+		Insert(Index);
+	}
+
+	FFlowTimerHandle Handle;
+	Handle.Index = Index;
+	Handle.Serial = Timer.Serial;
+	return Handle;
+}
+
+void FFlowTimerWheel::ClearTimer(FFlowTimerHandle& Handle)
+{
+	if (FindTimer(Handle))
+	{
+		Release(Handle.Index);
+	}
+
+	Handle.Invalidate();
+}
+
+bool FFlowTimerWheel::IsTimerActive(const FFlowTimerHandle& Handle) const
+{
+	return FindTimer(Handle) != nullptr;
+}
+
+uint32 FFlowTimerWheel::GetTicksRemaining(const FFlowTimerHandle& Handle) const
+{
+	if (const FTimer* Timer = FindTimer(Handle))
+	{
+		return Timer->bPaused ? Timer->PausedTicksRemaining : static_cast<uint32>(Timer->DueTick - CurrentTick);
+	}
+
+	return 0;
+}
+
+void FFlowTimerWheel::SetPaused(const UFlowAsset* RootFlow, const bool bPaused)
+{
+	for (int32 Index = 0; Index < Timers.Num(); Index++)
+	{
+		FTimer& Timer = Timers[Index];
+		if (!Timer.bActive || Timer.bPaused == bPaused || Timer.RootFlow.Get() != RootFlow)
+		{
+			continue;
+		}
+
+		Timer.bPaused = bPaused;
+		if (bPaused)
+		{
+			Timer.PausedTicksRemaining = static_cast<uint32>(Timer.DueTick - CurrentTick);
+			Timer.Generation++;
+			PausedTimersNum++;
+		}
+		else
+		{
+			Timer.DueTick = CurrentTick + FMath::Max<uint32>(Timer.PausedTicksRemaining, 1);
+			Insert(Index);
+			PausedTimersNum--;
+		}
+	}
+}
+
+void FFlowTimerWheel::Tick()
+{
+	CurrentTick++;
+
+	// entering the new round of the root slots, move timers from the next level down
+	const int32 RootIndex = static_cast<int32>(CurrentTick & (RootSize - 1));
+	if (RootIndex == 0)
+	{
+		int32 Level = 0;
+		for (; Level < NumLevels; Level++)
+		{
+			const int32 SlotIndex = static_cast<int32>((CurrentTick >> (RootBits + Level * LevelBits)) & (LevelSize - 1));
+			Cascade(LevelSlots[Level][SlotIndex]);
+
+			// the next level moves only if this one has started a new round too
+			if (SlotIndex != 0)
+			{
+				break;
+			}
+		}
+
+		if (Level == NumLevels)
+		{
+			Cascade(OverflowSlot);
+		}
+	}
+
+	Exchange(DueEntries, RootSlots[RootIndex]);
+
+	// delegates might set, clear or pause timers, even reset the wheel
+	for (int32 i = 0; i < DueEntries.Num(); i++)
+	{
+		const FSlotEntry Entry = DueEntries[i];
+		if (!Timers.IsValidIndex(Entry.Index) || Timers[Entry.Index].Generation != Entry.Generation)
+		{
+			continue;
+		}
+
+		FTimer& Timer = Timers[Entry.Index];
+		FFlowTimerDelegate Delegate;
+
+		// looping timer is scheduled again before the call, so the delegate can clear it
+		if (Timer.IntervalTicks > 0)
+		{
+			Delegate = Timer.Delegate;
+			Timer.DueTick = CurrentTick + Timer.IntervalTicks;
+			Insert(Entry.Index);
+		}
+		else
+		{
+			Delegate = MoveTemp(Timer.Delegate);
+			Release(Entry.Index);
+		}
+
+		Delegate.ExecuteIfBound();
+	}
+
+	DueEntries.Reset();
+}
+
+void FFlowTimerWheel::Reset()
+{
+	for (TArray<FSlotEntry>& Slot : RootSlots)
+	{
+		Slot.Empty();
+	}
+
+	for (int32 Level = 0; Level < NumLevels; Level++)
+	{
+		for (TArray<FSlotEntry>& Slot : LevelSlots[Level])
+		{
+			Slot.Empty();
+		}
+	}
+
+	OverflowSlot.Empty();
+	DueEntries.Reset();
+
+	Timers.Empty();
+	FreeTimers.Empty();
+
+	CurrentTick = 0;
+	ActiveTimersNum = 0;
+	PausedTimersNum = 0;
+}
+
+const FFlowTimerWheel::FTimer* FFlowTimerWheel::FindTimer(const FFlowTimerHandle& Handle) const
+{
+	if (Timers.IsValidIndex(Handle.Index))
+	{
+		const FTimer& Timer = Timers[Handle.Index];
+		if (Timer.bActive && Timer.Serial == Handle.Serial)
+		{
+			return &Timer;
+		}
+	}
+
+	return nullptr;
+}
+
+void FFlowTimerWheel::Insert(const int32 Index)
+{
+	const FTimer& Timer = Timers[Index];
+	const FSlotEntry Entry{Index, Timer.Generation};
+
+	// slot is chosen by the absolute due tick, so the timer cascades down exactly when its range comes
+	const uint64 DueTick = FMath::Max(Timer.DueTick, CurrentTick);
+	const uint64 Delta = DueTick - CurrentTick;
+
+	if (Delta < RootSize)
+	{
+		RootSlots[DueTick & (RootSize - 1)].Add(Entry);
+		return;
+	}
+
+	for (int32 Level = 0; Level < NumLevels; Level++)
+	{
+		const int32 Shift = RootBits + Level * LevelBits;
+		if (Delta < (1ull << (Shift + LevelBits)))
+		{
+			LevelSlots[Level][(DueTick >> Shift) & (LevelSize - 1)].Add(Entry);
+			return;
+		}
+	}
+
+	OverflowSlot.Add(Entry);
+}
+
+void FFlowTimerWheel::Cascade(TArray<FSlotEntry>& Slot)
+{
+	if (Slot.Num() == 0)
+	{
+		return;
+	}
+
+	const TArray<FSlotEntry> Entries = MoveTemp(Slot);
+	for (const FSlotEntry& Entry : Entries)
+	{
+		// stale entries of cleared or paused timers are dropped here
+		if (Timers[Entry.Index].Generation == Entry.Generation)
+		{
+			Insert(Entry.Index);
+		}
+	}
+}
+
+void FFlowTimerWheel::Release(const int32 Index)
+{
+	FTimer& Timer = Timers[Index];
+	if (Timer.bPaused)
+	{
+		PausedTimersNum--;
+	}
+
+	Timer.Delegate.Unbind();
+	Timer.RootFlow.Reset();
+	Timer.bActive = false;
+	Timer.bPaused = false;
+	Timer.Serial++;
+	Timer.Generation++;
+
+	ActiveTimersNum--;
+	FreeTimers.Add(Index);
+}
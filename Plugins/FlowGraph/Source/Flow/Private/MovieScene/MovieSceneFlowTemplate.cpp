@@ -2,8 +2,11 @@
 
 #include "MovieScene/MovieSceneFlowTemplate.h"
 #include "MovieScene/MovieSceneFlowTrack.h"
+#include "LevelSequence/FlowLevelSequencePlayer.h"
 #include "Nodes/World/FlowNode_PlayLevelSequence.h"
 
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
 #include "Evaluation/MovieSceneEvaluation.h"
 #include "IMovieScenePlayer.h"
 
@@ -13,24 +16,63 @@
 
 DECLARE_CYCLE_STAT(TEXT("Flow Track Token Execute"), MovieSceneEval_FlowTrack_TokenExecute, STATGROUP_MovieSceneEval);
 
+// Flow nodes receiving events of the section, resolved once per player
+struct FFlowTrackEventReceivers final : IPersistentEvaluationData
+{
+	TArray<TWeakObjectPtr<UFlowNode_PlayLevelSequence>, TInlineAllocator<1>> Nodes;
+	bool bResolved = false;
+
+	void Resolve(IMovieScenePlayer& Player)
+	{
+		bResolved = true;
+		Nodes.Reset();
+
+		// Flow player knows its receiver, so we don't need to gather event contexts
+		if (const UFlowLevelSequencePlayer* FlowPlayer = Cast<UFlowLevelSequencePlayer>(Player.AsUObject()))
+		{
+			if (UFlowNode_PlayLevelSequence* FlowNode = Cast<UFlowNode_PlayLevelSequence>(FlowPlayer->GetFlowEventReceiver()))
+			{
+				Nodes.Add(FlowNode);
+			}
+			return;
+		}
+
+		for (UObject* EventReceiver : Player.GetEventContexts())
+		{
+			if (UFlowNode_PlayLevelSequence* FlowNode = Cast<UFlowNode_PlayLevelSequence>(EventReceiver))
+			{
+				Nodes.Add(FlowNode);
+			}
+		}
+	}
+};
+
 struct FFlowTrackExecutionToken final : IMovieSceneExecutionToken
 {
-	FFlowTrackExecutionToken(TArray<FString> InEventNames)
+	typedef TArray<FName, TInlineAllocator<4>> FEventNames;
+
+	FFlowTrackExecutionToken(FEventNames&& InEventNames)
 		: EventNames(MoveTemp(InEventNames))
 	{
 	}
 
-	TArray<FString> EventNames;
+	FEventNames EventNames;
 
 	virtual void Execute(const FMovieSceneContext& Context, const FMovieSceneEvaluationOperand& Operand, FPersistentEvaluationData& PersistentData, IMovieScenePlayer& Player) override
 	{
 		MOVIESCENE_DETAILED_SCOPE_CYCLE_COUNTER(MovieSceneEval_FlowTrack_TokenExecute)
 
-		for (const FString& EventName : EventNames)
+		FFlowTrackEventReceivers& Receivers = PersistentData.GetOrAddSectionData<FFlowTrackEventReceivers>();
+		if (!Receivers.bResolved)
+		{
+			Receivers.Resolve(Player);
+		}
+
+		for (const FName& EventName : EventNames)
 		{
-			for (UObject* EventReceiver : Player.GetEventContexts())
+			for (const TWeakObjectPtr<UFlowNode_PlayLevelSequence>& FlowNode : Receivers.Nodes)
 			{
-				if (UFlowNode_PlayLevelSequence* FlowNode = Cast<UFlowNode_PlayLevelSequence>(EventReceiver))
+				if (FlowNode.IsValid())
 				{
 					FlowNode->TriggerEvent(EventName);
 				}
@@ -46,13 +88,25 @@ FMovieSceneFlowTriggerTemplate::FMovieSceneFlowTriggerTemplate(const UMovieScene
 	const TArrayView<const FFrameNumber> Times = EventData.GetTimes();
 	const TArrayView<const FString> EntryPoints = EventData.GetValues();
 
-	EventTimes.Reserve(Times.Num());
-	EventNames.Reserve(Times.Num());
-
+	// Channel keeps keys sorted, but it's cheap to ensure it here, as evaluation relies on it
+	TArray<int32> SortedIndices;
+	SortedIndices.Reserve(Times.Num());
 	for (int32 Index = 0; Index < Times.Num(); ++Index)
+	{
+		if (!EntryPoints[Index].IsEmpty())
+		{
+			SortedIndices.Add(Index);
+		}
+	}
+	Algo::StableSortBy(SortedIndices, [&Times](const int32 Index) { return Times[Index]; });
+
+	EventTimes.Reserve(SortedIndices.Num());
+	EventNames.Reserve(SortedIndices.Num());
+
+	for (const int32 Index : SortedIndices)
 	{
 		EventTimes.Add(Times[Index]);
-		EventNames.Add(EntryPoints[Index]);
+		EventNames.Add(FName(*EntryPoints[Index]));
 	}
 }
 
@@ -73,42 +127,61 @@ void FMovieSceneFlowTriggerTemplate::EvaluateSwept(const FMovieSceneEvaluationOp
 		return;
 	}
 
-	TArray<FString> EventsToTrigger;
+	// Find events within the swept range, [FirstIndex, EndIndex)
+	int32 FirstIndex = 0;
+	int32 EndIndex = EventTimes.Num();
+
+	const TRangeBound<FFrameNumber> LowerBound = SweptRange.GetLowerBound();
+	if (LowerBound.IsInclusive())
+	{
+		FirstIndex = Algo::LowerBound(EventTimes, LowerBound.GetValue());
+	}
+	else if (LowerBound.IsExclusive())
+	{
+		FirstIndex = Algo::UpperBound(EventTimes, LowerBound.GetValue());
+	}
+
+	const TRangeBound<FFrameNumber> UpperBound = SweptRange.GetUpperBound();
+	if (UpperBound.IsInclusive())
+	{
+		EndIndex = Algo::UpperBound(EventTimes, UpperBound.GetValue());
+	}
+	else if (UpperBound.IsExclusive())
+	{
+		EndIndex = Algo::LowerBound(EventTimes, UpperBound.GetValue());
+	}
+
+	if (FirstIndex >= EndIndex)
+	{
+		return;
+	}
+
+	FFlowTrackExecutionToken::FEventNames EventsToTrigger;
+	EventsToTrigger.Reserve(EndIndex - FirstIndex);
 
 	if (bBackwards)
 	{
 		// Trigger events backwards
-		for (int32 KeyIndex = EventTimes.Num() - 1; KeyIndex >= 0; --KeyIndex)
+		for (int32 KeyIndex = EndIndex - 1; KeyIndex >= FirstIndex; --KeyIndex)
 		{
-			FFrameNumber Time = EventTimes[KeyIndex];
-			if (!EventNames[KeyIndex].IsEmpty() && SweptRange.Contains(Time))
-			{
-				EventsToTrigger.Add(EventNames[KeyIndex]);
-			}
+			EventsToTrigger.Add(EventNames[KeyIndex]);
 		}
 	}
 	else
 	{
 		// Trigger events forwards
-		for (int32 KeyIndex = 0; KeyIndex < EventTimes.Num(); ++KeyIndex)
+		for (int32 KeyIndex = FirstIndex; KeyIndex < EndIndex; ++KeyIndex)
 		{
-			FFrameNumber Time = EventTimes[KeyIndex];
-			if (!EventNames[KeyIndex].IsEmpty() && SweptRange.Contains(Time))
-			{
-				EventsToTrigger.Add(EventNames[KeyIndex]);
-			}
+			EventsToTrigger.Add(EventNames[KeyIndex]);
 		}
 	}
 
-	if (EventsToTrigger.Num())
-	{
-		ExecutionTokens.Add(FFlowTrackExecutionToken(MoveTemp(EventsToTrigger)));
-	}
+	ExecutionTokens.Add(FFlowTrackExecutionToken(MoveTemp(EventsToTrigger)));
 }
 
 FMovieSceneFlowRepeaterTemplate::FMovieSceneFlowRepeaterTemplate(const UMovieSceneFlowRepeaterSection& Section, const UMovieSceneFlowTrack& Track)
 	: FMovieSceneFlowTemplateBase(Track, Section)
-	, EventName(Section.EventName)
+	, EventName(*Section.EventName)
 {
 }
 
@@ -120,7 +193,7 @@ void FMovieSceneFlowRepeaterTemplate::EvaluateSwept(const FMovieSceneEvaluationO
 	// Don't allow events to fire when playback is in a stopped state. This can occur when stopping 
 	// playback and returning the current position to the start of playback. It's not desirable to have 
 	// all the events from the last playback position to the start of playback be fired.
-	if (EventName.IsEmpty() || !SweptRange.Contains(CurrentFrame) || Context.GetStatus() == EMovieScenePlayerStatus::Stopped || Context.IsSilent())
+	if (EventName.IsNone() || !SweptRange.Contains(CurrentFrame) || Context.GetStatus() == EMovieScenePlayerStatus::Stopped || Context.IsSilent())
 	{
 		return;
 	}
@@ -4,7 +4,9 @@
 #include "AddOns/FlowNodeAddOn.h"
 
 #include "FlowAsset.h"
+#include "FlowProfiler.h"
 #include "FlowSettings.h"
+#include "FlowSubsystem.h"
 
 #include "Components/ActorComponent.h"
 #if WITH_EDITOR
@@ -13,8 +15,6 @@
 
 #include "GameFramework/Actor.h"
 #include "Misc/App.h"
-#include "Serialization/MemoryReader.h"
-#include "Serialization/MemoryWriter.h"
 
 FFlowPin UFlowNode::DefaultInputPin(TEXT("In"));
 FFlowPin UFlowNode::DefaultOutputPin(TEXT("Out"));
@@ -28,8 +28,13 @@ UFlowNode::UFlowNode(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, AllowedSignalModes({EFlowSignalMode::Enabled, EFlowSignalMode::Disabled, EFlowSignalMode::PassThrough})
 	, SignalMode(EFlowSignalMode::Enabled)
+	, CompiledIndex(INDEX_NONE)
 	, bPreloaded(false)
 	, ActivationState(EFlowNodeState::NeverActivated)
+	, ActiveNodeIndex(INDEX_NONE)
+	, bAlwaysCallOnSave(false)
+	, bSaveDirty(true)
+	, SaveDataHash(0)
 {
 #if WITH_EDITOR
 	Category = TEXT("Uncategorized");
@@ -338,7 +343,7 @@ TSet<UFlowNode*> UFlowNode::GetConnectedNodes() const
 	TSet<UFlowNode*> Result;
 	for (const TPair<FName, FConnectedPin>& Connection : Connections)
 	{
-		Result.Emplace(GetFlowAsset()->GetNode(Connection.Value.NodeGuid));
+		Result.Emplace(GetFlowAsset()->GetNodeInstance(Connection.Value.NodeGuid));
 	}
 	return Result;
 }
@@ -358,24 +363,17 @@ FName UFlowNode::GetPinConnectedToNode(const FGuid& OtherNodeGuid)
 
 bool UFlowNode::IsInputConnected(const FName& PinName) const
 {
-	if (GetFlowAsset())
+	return GetInputConnections(PinName).Num() > 0;
+}
+
+TConstArrayView<FConnectedPin> UFlowNode::GetInputConnections(const FName& PinName) const
+{
+	if (const UFlowAsset* FlowAsset = GetFlowAsset())
 	{
-		for (const TPair<FGuid, UFlowNode*>& Pair : GetFlowAsset()->Nodes)
-		{
-			if (Pair.Value)
-			{
-				for (const TPair<FName, FConnectedPin>& Connection : Pair.Value->Connections)
-				{
-					if (Connection.Value.NodeGuid == NodeGuid && Connection.Value.PinName == PinName)
-					{
-						return true;
-					}
-				}
-			}
-		}
+		return FlowAsset->GetInputConnections(NodeGuid, PinName);
 	}
 
-	return false;
+	return TConstArrayView<FConnectedPin>();
 }
 
 bool UFlowNode::IsOutputConnected(const FName& PinName) const
@@ -406,64 +404,140 @@ void UFlowNode::RecursiveFindNodesByClass(UFlowNode* Node, const TSubclassOf<UFl
 	}
 }
 
+const FFlowCompiledGraph* UFlowNode::GetCompiledGraph() const
+{
+	if (CompiledIndex != INDEX_NONE)
+	{
+		if (const UFlowAsset* FlowAsset = GetFlowAsset())
+		{
+			return FlowAsset->GetCompiledGraph();
+		}
+	}
+
+	return nullptr;
+}
+
+uint16 UFlowNode::FindInputPinIndex(const FName& PinName) const
+{
+	if (const FFlowCompiledGraph* CompiledGraph = GetCompiledGraph())
+	{
+		return CompiledGraph->FindInputPinIndex(CompiledIndex, PinName);
+	}
+
+	// node isn't part of the compiled graph, i.e. template node
+	const int32 FoundIndex = InputPins.IndexOfByKey(PinName);
+	return FoundIndex == INDEX_NONE ? InvalidPinIndex : static_cast<uint16>(FoundIndex);
+}
+
+uint16 UFlowNode::FindOutputPinIndex(const FName& PinName) const
+{
+	if (const FFlowCompiledGraph* CompiledGraph = GetCompiledGraph())
+	{
+		return CompiledGraph->FindOutputPinIndex(CompiledIndex, PinName);
+	}
+
+	// node isn't part of the compiled graph, i.e. template node
+	const int32 FoundIndex = OutputPins.IndexOfByKey(PinName);
+	return FoundIndex == INDEX_NONE ? InvalidPinIndex : static_cast<uint16>(FoundIndex);
+}
+
 void UFlowNode::TriggerPreload()
 {
+	if (!EnsureNodeInstance(TEXT("preloaded")))
+	{
+		return;
+	}
+
 	bPreloaded = true;
 	PreloadContent();
 }
 
 void UFlowNode::TriggerFlush()
 {
+	if (!EnsureNodeInstance(TEXT("flushed")))
+	{
+		return;
+	}
+
 	bPreloaded = false;
 	FlushContent();
 }
 
+bool UFlowNode::IsTemplateNode() const
+{
+	// asset instances always have the template asset, so the node is owned by the asset itself
+	const UFlowAsset* FlowAsset = GetFlowAsset();
+	return FlowAsset && FlowAsset->GetTemplateAsset() == nullptr && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+bool UFlowNode::EnsureNodeInstance(const TCHAR* Operation) const
+{
+	return ensureMsgf(!IsTemplateNode(), TEXT("Template node %s can't be %s, use GetNodeInstance() of the asset instance"), *GetName(), Operation);
+}
+
 void UFlowNode::TriggerInput(const FName& PinName, const EFlowPinActivationType ActivationType /*= Default*/)
 {
-	if (SignalMode == EFlowSignalMode::Disabled)
+	const uint16 InputPinIndex = FindInputPinIndex(PinName);
+	if (InputPinIndex == InvalidPinIndex)
 	{
-		// entirely ignore any Input activation
+#if !UE_BUILD_SHIPPING
+		LogError(FString::Printf(TEXT("Input Pin name %s invalid"), *PinName.ToString()));
+#endif // UE_BUILD_SHIPPING
+		return;
 	}
 
-	if (InputPins.Contains(PinName))
-	{
-		if (SignalMode == EFlowSignalMode::Enabled)
-		{
-			const EFlowNodeState PreviousActivationState = ActivationState;
-			if (PreviousActivationState != EFlowNodeState::Active)
-			{
-				OnActivate();
-			}
+	TriggerInputByIndex(InputPinIndex, ActivationType);
+}
 
-			ActivationState = EFlowNodeState::Active;
-		}
+void UFlowNode::TriggerInputByIndex(const uint16 InputPinIndex, const EFlowPinActivationType ActivationType /*= Default*/)
+{
+	if (!EnsureNodeInstance(TEXT("triggered")))
+	{
+		return;
+	}
 
+	if (!InputPins.IsValidIndex(InputPinIndex))
+	{
 #if !UE_BUILD_SHIPPING
-		// record for debugging
-		TArray<FPinRecord>& Records = InputRecords.FindOrAdd(PinName);
-		Records.Add(FPinRecord(FApp::GetCurrentTime(), ActivationType));
+		LogError(FString::Printf(TEXT("Input Pin index %d invalid"), InputPinIndex));
 #endif // UE_BUILD_SHIPPING
+		return;
+	}
 
-#if WITH_EDITOR
-		if (GEditor && UFlowAsset::GetFlowGraphInterface().IsValid())
+	const FName& PinName = InputPins[InputPinIndex].PinName;
+
+	if (SignalMode == EFlowSignalMode::Enabled)
+	{
+		const EFlowNodeState PreviousActivationState = ActivationState;
+		if (PreviousActivationState != EFlowNodeState::Active)
 		{
-			UFlowAsset::GetFlowGraphInterface()->OnInputTriggered(GraphNode, InputPins.IndexOfByKey(PinName));
+			OnActivate();
 		}
-#endif // WITH_EDITOR
+
+		ActivationState = EFlowNodeState::Active;
+		MarkSaveDirty();
 	}
-	else
+
+#if FLOW_WITH_PIN_RECORDS
+	// record for debugging
+	AddPinRecord(InputRecords, InputPins.Num(), InputPinIndex, ActivationType);
+#endif // FLOW_WITH_PIN_RECORDS
+
+#if WITH_EDITOR
+	if (GEditor && UFlowAsset::GetFlowGraphInterface().IsValid())
 	{
-#if !UE_BUILD_SHIPPING
-		LogError(FString::Printf(TEXT("Input Pin name %s invalid"), *PinName.ToString()));
-#endif // UE_BUILD_SHIPPING
-		return;
+		UFlowAsset::GetFlowGraphInterface()->OnInputTriggered(GraphNode, InputPinIndex);
 	}
+#endif // WITH_EDITOR
 
 	switch (SignalMode)
 	{
 		case EFlowSignalMode::Enabled:
+		{
+			const FFlowNodeExecutionScope ExecutionScope(*this);
 			ExecuteInput(PinName);
 			break;
+		}
 		case EFlowSignalMode::Disabled:
 			if (UFlowSettings::Get()->bLogOnSignalDisabled)
 			{
@@ -491,6 +565,13 @@ void UFlowNode::TriggerFirstOutput(const bool bFinish)
 
 void UFlowNode::TriggerOutput(const FName PinName, const bool bFinish /*= false*/, const EFlowPinActivationType ActivationType /*= Default*/)
 {
+	const uint16 OutputPinIndex = FindOutputPinIndex(PinName);
+	if (OutputPinIndex != InvalidPinIndex)
+	{
+		TriggerOutputByIndex(OutputPinIndex, bFinish, ActivationType);
+		return;
+	}
+
 	// clean up node, if needed
 	if (bFinish)
 	{
@@ -498,35 +579,92 @@ void UFlowNode::TriggerOutput(const FName PinName, const bool bFinish /*= false*
 	}
 
 #if !UE_BUILD_SHIPPING
-	if (OutputPins.Contains(PinName))
-	{
-		// record for debugging, even if nothing is connected to this pin
-		TArray<FPinRecord>& Records = OutputRecords.FindOrAdd(PinName);
-		Records.Add(FPinRecord(FApp::GetCurrentTime(), ActivationType));
+	LogError(FString::Printf(TEXT("Output Pin name %s invalid"), *PinName.ToString()));
+#endif // UE_BUILD_SHIPPING
+}
 
-#if WITH_EDITOR
-		if (GEditor && UFlowAsset::GetFlowGraphInterface().IsValid())
-		{
-			UFlowAsset::GetFlowGraphInterface()->OnOutputTriggered(GraphNode, OutputPins.IndexOfByKey(PinName));
-		}
-#endif // WITH_EDITOR
+void UFlowNode::TriggerOutputByIndex(const uint16 OutputPinIndex, const bool bFinish /*= false*/, const EFlowPinActivationType ActivationType /*= Default*/)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowTriggerOutput);
+	INC_DWORD_STAT(STAT_FlowTriggeredOutputs);
+
+	if (!EnsureNodeInstance(TEXT("triggered")))
+	{
+		return;
 	}
-	else
+
+	// clean up node, if needed
+	if (bFinish)
 	{
-		LogError(FString::Printf(TEXT("Output Pin name %s invalid"), *PinName.ToString()));
+		Finish();
 	}
+
+	if (!OutputPins.IsValidIndex(OutputPinIndex))
+	{
+#if !UE_BUILD_SHIPPING
+		LogError(FString::Printf(TEXT("Output Pin index %d invalid"), OutputPinIndex));
 #endif // UE_BUILD_SHIPPING
+		return;
+	}
+
+#if FLOW_WITH_PIN_RECORDS
+	// record for debugging, even if nothing is connected to this pin
+	AddPinRecord(OutputRecords, OutputPins.Num(), OutputPinIndex, ActivationType);
+#endif // FLOW_WITH_PIN_RECORDS
+
+#if WITH_EDITOR
+	if (GEditor && UFlowAsset::GetFlowGraphInterface().IsValid())
+	{
+		UFlowAsset::GetFlowGraphInterface()->OnOutputTriggered(GraphNode, OutputPinIndex);
+	}
+#endif // WITH_EDITOR
 
 	// call the next node
-	if (OutputPins.Contains(PinName) && Connections.Contains(PinName))
+	if (const FFlowCompiledGraph* CompiledGraph = GetCompiledGraph())
+	{
+		const FFlowCompiledRoute* Route = CompiledGraph->FindRoute(CompiledIndex, OutputPinIndex);
+		if (Route && Route->IsConnected())
+		{
+			// connected pin doesn't exist anymore, i.e. the connected node changed its pins without refreshing the graph
+			if (Route->InputPinIndex == InvalidPinIndex)
+			{
+#if !UE_BUILD_SHIPPING
+				LogError(FString::Printf(TEXT("Output Pin %s is connected to invalid Input Pin"), *OutputPins[OutputPinIndex].PinName.ToString()));
+#endif
+				return;
+			}
+
+			UFlowAsset* FlowAsset = GetFlowAsset();
+			if (UFlowNode* ConnectedNode = FlowAsset->GetNodeInstanceByIndex(Route->NodeIndex))
+			{
+				if (ConnectedNode->InputPins.IsValidIndex(Route->InputPinIndex))
+				{
+					FFlowTrace::OutputSignal(*this, OutputPins[OutputPinIndex].PinName, *ConnectedNode, ConnectedNode->InputPins[Route->InputPinIndex].PinName);
+				}
+
+				FlowAsset->TriggerInput(ConnectedNode, Route->InputPinIndex);
+			}
+		}
+	}
+	else if (const FConnectedPin* Connection = Connections.Find(OutputPins[OutputPinIndex].PinName))
 	{
-		const FConnectedPin FlowPin = GetConnection(PinName);
-		GetFlowAsset()->TriggerInput(FlowPin.NodeGuid, FlowPin.PinName);
+		// node isn't part of the compiled graph
+		if (const UFlowNode* ConnectedNode = GetFlowAsset()->GetNode(Connection->NodeGuid))
+		{
+			FFlowTrace::OutputSignal(*this, OutputPins[OutputPinIndex].PinName, *ConnectedNode, Connection->PinName);
+		}
+
+		GetFlowAsset()->TriggerInput(Connection->NodeGuid, Connection->PinName);
 	}
 }
 
 void UFlowNode::Finish()
 {
+	if (!EnsureNodeInstance(TEXT("finished")))
+	{
+		return;
+	}
+
 	Deactivate();
 	GetFlowAsset()->FinishNode(this);
 }
@@ -542,34 +680,85 @@ void UFlowNode::Deactivate()
 		ActivationState = EFlowNodeState::Completed;
 	}
 
+	MarkSaveDirty();
 	Cleanup();
 }
 
+void UFlowNode::ResetInstance()
+{
+	Super::ResetInstance();
+
+	ActiveNodeIndex = INDEX_NONE;
+	bPreloaded = false;
+	ResetRecords();
+}
+
 void UFlowNode::ResetRecords()
 {
 	ActivationState = EFlowNodeState::NeverActivated;
+	bSaveDirty = true;
 
-#if !UE_BUILD_SHIPPING
-	InputRecords.Empty();
-	OutputRecords.Empty();
+#if FLOW_WITH_PIN_RECORDS
+	// keep allocated history, so node re-used in another run doesn't allocate it again
+	for (FPinRecordHistory& Records : InputRecords)
+	{
+		Records.Reset();
+	}
+	for (FPinRecordHistory& Records : OutputRecords)
+	{
+		Records.Reset();
+	}
 #endif
 }
 
+#if FLOW_WITH_PIN_RECORDS
+void UFlowNode::AddPinRecord(TArray<FPinRecordHistory>& Records, const int32 PinsNum, const uint16 PinIndex, const EFlowPinActivationType ActivationType)
+{
+	if (Records.Num() != PinsNum)
+	{
+		Records.SetNum(PinsNum);
+	}
+
+	Records[PinIndex].Add(FPinRecord(FApp::GetCurrentTime(), ActivationType), UFlowSettings::Get()->MaxPinRecords);
+}
+#endif
+
 void UFlowNode::SaveInstance(FFlowNodeSaveData& NodeRecord)
 {
 	NodeRecord.NodeGuid = NodeGuid;
+	NodeRecord.SchemaVersion = FFlowSaveVersion::LatestVersion;
 	OnSave();
+	if (bAlwaysCallOnSave)
+	{
+		SaveDataHash = FFlowSaveSerialization::HashObject(this);
+	}
 
-	FMemoryWriter MemoryWriter(NodeRecord.NodeData, true);
-	FFlowArchive Ar(MemoryWriter);
-	Serialize(Ar);
+	UFlowSubsystem* FlowSubsystem = GetFlowSubsystem();
+	if (FlowSubsystem == nullptr || !FlowSubsystem->DeferSerialization(this, NodeRecord.PendingSerialization))
+	{
+		FFlowSaveSerialization::SerializeObject(this, NodeRecord.NodeData, NodeRecord.CompressionFormat, NodeRecord.UncompressedSize);
+	}
+	bSaveDirty = false;
+}
+
+void UFlowNode::UpdateSaveDirty()
+{
+	if (bAlwaysCallOnSave && !IsSaveDirty())
+	{
+		OnSave();
+		bSaveDirty = FFlowSaveSerialization::HashObject(this) != SaveDataHash;
+	}
 }
 
 void UFlowNode::LoadInstance(const FFlowNodeSaveData& NodeRecord)
 {
-	FMemoryReader MemoryReader(NodeRecord.NodeData, true);
-	FFlowArchive Ar(MemoryReader);
-	Serialize(Ar);
+	const UFlowSaveGame* SaveGame = GetFlowSubsystem() ? GetFlowSubsystem()->GetLoadedSaveGame() : nullptr;
+	if (!FFlowSaveSerialization::DeserializeObject(this, NodeRecord.NodeData, NodeRecord.CompressionFormat, NodeRecord.UncompressedSize,
+	                                               NodeRecord.SchemaVersion, NodeRecord.bNameTableEncoding, SaveGame))
+	{
+		LogError(TEXT("Failed to load node data from SaveGame"));
+		return;
+	}
 
 	if (UFlowAsset* FlowAsset = GetFlowAsset())
 	{
@@ -594,6 +783,17 @@ void UFlowNode::LoadInstance(const FFlowNodeSaveData& NodeRecord)
 	}
 }
 
+void UFlowNode::MarkSaveDirty()
+{
+	bSaveDirty = true;
+
+	// asset record needs to be updated, even if this node won't be saved anymore
+	if (UFlowAsset* FlowAsset = GetFlowAsset())
+	{
+		FlowAsset->bSaveDirty = true;
+	}
+}
+
 void UFlowNode::OnSave_Implementation()
 {
 }
@@ -606,11 +806,11 @@ void UFlowNode::OnPassThrough_Implementation()
 {
 	// trigger all connected outputs
 	// pin connections aren't serialized to the SaveGame, so users can safely change connections post game release
-	for (const FFlowPin& OutputPin : OutputPins)
+	for (int32 i = 0; i < OutputPins.Num(); i++)
 	{
-		if (Connections.Contains(OutputPin.PinName))
+		if (Connections.Contains(OutputPins[i].PinName))
 		{
-			TriggerOutput(OutputPin.PinName, false, EFlowPinActivationType::PassThrough);
+			TriggerOutput(OutputPins[i].PinName, false, EFlowPinActivationType::PassThrough);
 		}
 	}
 
@@ -622,24 +822,39 @@ void UFlowNode::OnPassThrough_Implementation()
 TMap<uint8, FPinRecord> UFlowNode::GetWireRecords() const
 {
 	TMap<uint8, FPinRecord> Result;
-	for (const TPair<FName, TArray<FPinRecord>>& Record : OutputRecords)
+#if FLOW_WITH_PIN_RECORDS
+	for (int32 PinIndex = 0; PinIndex < OutputRecords.Num(); PinIndex++)
 	{
-		Result.Emplace(OutputPins.IndexOfByKey(Record.Key), Record.Value.Last());
+		if (OutputRecords[PinIndex].Num() > 0)
+		{
+			Result.Emplace(PinIndex, OutputRecords[PinIndex].Last());
+		}
 	}
+#endif
 	return Result;
 }
 
 TArray<FPinRecord> UFlowNode::GetPinRecords(const FName& PinName, const EEdGraphPinDirection PinDirection) const
 {
+#if FLOW_WITH_PIN_RECORDS
 	switch (PinDirection)
 	{
 		case EGPD_Input:
-			return InputRecords.FindRef(PinName);
+		{
+			const uint16 PinIndex = FindInputPinIndex(PinName);
+			return InputRecords.IsValidIndex(PinIndex) ? InputRecords[PinIndex].GetRecords() : TArray<FPinRecord>();
+		}
 		case EGPD_Output:
-			return OutputRecords.FindRef(PinName);
+		{
+			const uint16 PinIndex = FindOutputPinIndex(PinName);
+			return OutputRecords.IsValidIndex(PinIndex) ? OutputRecords[PinIndex].GetRecords() : TArray<FPinRecord>();
+		}
 		default:
 			return TArray<FPinRecord>();
 	}
+#else
+	return TArray<FPinRecord>();
+#endif
 }
 #endif
 
@@ -671,9 +886,9 @@ FString UFlowNode::GetProgressAsString(const float Value)
 #if WITH_EDITOR
 UFlowNode* UFlowNode::GetInspectedInstance() const
 {
-	if (const UFlowAsset* FlowInstance = GetFlowAsset()->GetInspectedInstance())
+	if (UFlowAsset* FlowInstance = GetFlowAsset()->GetInspectedInstance())
 	{
-		return FlowInstance->GetNode(GetGuid());
+		return FlowInstance->GetNodeInstance(GetGuid());
 	}
 
 	return nullptr;
@@ -62,7 +62,8 @@ void UFlowNodeBase::InitializeInstance()
 {
 	IFlowCoreExecutableInterface::InitializeInstance();
 
-	if (!AddOns.IsEmpty())
+	// AddOns are already instanced, if this node has been reused by the Flow Asset instance pool
+	if (!AddOns.IsEmpty() && AddOns[0]->GetOuter() != this)
 	{
 		TArray<UFlowNodeAddOn*> SourceAddOns = AddOns;
 		AddOns.Reset();
@@ -71,14 +72,15 @@ void UFlowNodeBase::InitializeInstance()
 		{
 			// Create a new instance of each AddOn
 			UFlowNodeAddOn* NewAddOnInstance = NewObject<UFlowNodeAddOn>(this, SourceAddOn->GetClass(), NAME_None, RF_Transient, SourceAddOn, false, nullptr);
+			NewAddOnInstance->InstanceTemplate = SourceAddOn;
 			AddOns.Add(NewAddOnInstance);
 		}
+	}
 
-		for (UFlowNodeAddOn* AddOn : AddOns)
-		{
-			// Initialize all the AddOn instances after they are all allocated
-			AddOn->InitializeInstance();
-		}
+	for (UFlowNodeAddOn* AddOn : AddOns)
+	{
+		// Initialize all the AddOn instances after they are all allocated
+		AddOn->InitializeInstance();
 	}
 }
 
@@ -92,6 +94,28 @@ void UFlowNodeBase::DeinitializeInstance()
 	IFlowCoreExecutableInterface::DeinitializeInstance();
 }
 
+void UFlowNodeBase::ResetInstance()
+{
+	// restore property values from the template, instanced subobjects (AddOns) are reset by themselves
+	if (const UFlowNodeBase* Template = InstanceTemplate.Get())
+	{
+		for (TFieldIterator<FProperty> It(GetClass()); It; ++It)
+		{
+			if (!It->ContainsInstancedObjectProperty())
+			{
+				It->CopyCompleteValue_InContainer(this, Template);
+			}
+		}
+	}
+
+	for (UFlowNodeAddOn* AddOn : AddOns)
+	{
+		AddOn->ResetInstance();
+	}
+
+	IFlowCoreExecutableInterface::ResetInstance();
+}
+
 void UFlowNodeBase::PreloadContent()
 {
 	IFlowCoreExecutableInterface::PreloadContent();
@@ -9,7 +9,7 @@
 //////////////////////////////////////////////////////////////////////////
 // Pin Record
 
-#if !UE_BUILD_SHIPPING
+#if !UE_BUILD_SHIPPING || FLOW_WITH_PIN_RECORDS
 FString FPinRecord::NoActivations = TEXT("No activations");
 FString FPinRecord::PinActivations = TEXT("Pin activations");
 FString FPinRecord::ForcedActivation = TEXT(" (forced activation)");
@@ -17,17 +17,20 @@ FString FPinRecord::PassThroughActivation = TEXT(" (pass-through activation)");
 
 FPinRecord::FPinRecord()
 	: Time(0.0f)
-	, HumanReadableTime(FString())
 	, ActivationType(EFlowPinActivationType::Default)
 {
 }
 
 FPinRecord::FPinRecord(const double InTime, const EFlowPinActivationType InActivationType)
 	: Time(InTime)
+	, SystemTime(FDateTime::Now())
 	, ActivationType(InActivationType)
 {
-	const FDateTime SystemTime(FDateTime::Now());
-	HumanReadableTime = DoubleDigit(SystemTime.GetHour()) + TEXT(".")
+}
+
+FString FPinRecord::GetHumanReadableTime() const
+{
+	return DoubleDigit(SystemTime.GetHour()) + TEXT(".")
 		+ DoubleDigit(SystemTime.GetMinute()) + TEXT(".")
 		+ DoubleDigit(SystemTime.GetSecond()) + TEXT(":")
 		+ DoubleDigit(SystemTime.GetMillisecond()).Left(3);
@@ -39,6 +42,48 @@ FORCEINLINE FString FPinRecord::DoubleDigit(const int32 Number)
 }
 #endif
 
+#if FLOW_WITH_PIN_RECORDS
+void FPinRecordHistory::Add(const FPinRecord& Record, const int32 InCapacity)
+{
+	const int32 NewCapacity = FMath::Max(1, InCapacity);
+	if (Capacity != NewCapacity)
+	{
+		// capacity has been changed in runtime, start a new history instead of reordering the existing one
+		Records.Empty(NewCapacity);
+		Head = 0;
+		Capacity = NewCapacity;
+	}
+
+	if (Records.Num() < Capacity)
+	{
+		Records.Add(Record);
+	}
+	else
+	{
+		Records[Head] = Record;
+		Head = (Head + 1) % Capacity;
+	}
+}
+
+void FPinRecordHistory::Reset()
+{
+	Records.Reset();
+	Head = 0;
+}
+
+TArray<FPinRecord> FPinRecordHistory::GetRecords() const
+{
+	TArray<FPinRecord> Result;
+	Result.Reserve(Records.Num());
+
+	for (int32 i = 0; i < Records.Num(); i++)
+	{
+		Result.Add(Records[(Head + i) % Records.Num()]);
+	}
+	return Result;
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 // Pin Trait
 
@@ -67,11 +67,18 @@ void UFlowNode_SubGraph::ExecuteInput(const FName& PinName)
 	{
 		if (GetFlowSubsystem())
 		{
-			GetFlowSubsystem()->CreateSubFlow(this);
+			// asset not loaded yet would cause a hitch
+			GetFlowSubsystem()->CreateSubFlowAsync(this);
 		}
 	}
 	else if (!PinName.IsNone())
 	{
+		// deliver it after Sub Flow starts, if asset is still loading
+		if (GetFlowSubsystem() && GetFlowSubsystem()->QueuePendingSubFlowInput(this, PinName))
+		{
+			return;
+		}
+
 		GetFlowAsset()->TriggerCustomInput_FromSubGraph(this, PinName);
 	}
 }
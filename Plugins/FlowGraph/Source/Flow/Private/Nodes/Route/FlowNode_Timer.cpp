@@ -1,6 +1,7 @@
 // Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
 
 #include "Nodes/Route/FlowNode_Timer.h"
+#include "FlowSubsystem.h"
 
 #include "Engine/World.h"
 #include "TimerManager.h"
@@ -53,16 +54,16 @@ void UFlowNode_Timer::ExecuteInput(const FName& PinName)
 
 void UFlowNode_Timer::SetTimer()
 {
-	if (GetWorld())
+	if (GetWorld() && GetFlowSubsystem())
 	{
 		if (StepTime > 0.0f)
 		{
-			GetWorld()->GetTimerManager().SetTimer(StepTimerHandle, this, &UFlowNode_Timer::OnStep, StepTime, true);
+			SetStepTimer(StepTime);
 		}
 
 		if (CompletionTime > UE_KINDA_SMALL_NUMBER)
 		{
-			GetWorld()->GetTimerManager().SetTimer(CompletionTimerHandle, this, &UFlowNode_Timer::OnCompletion, CompletionTime, false);
+			SetCompletionTimer(CompletionTime);
 		}
 		else
 		{
@@ -76,6 +77,16 @@ void UFlowNode_Timer::SetTimer()
 	}
 }
 
+void UFlowNode_Timer::SetStepTimer(const float FirstDelay)
+{
+	StepTimerHandle = GetFlowSubsystem()->SetFlowTimer(this, FFlowTimerDelegate::CreateUObject(this, &UFlowNode_Timer::OnStep), FirstDelay, StepTime);
+}
+
+void UFlowNode_Timer::SetCompletionTimer(const float Delay)
+{
+	CompletionTimerHandle = GetFlowSubsystem()->SetFlowTimer(this, FFlowTimerDelegate::CreateUObject(this, &UFlowNode_Timer::OnCompletion), Delay);
+}
+
 void UFlowNode_Timer::Restart()
 {
 	Cleanup();
@@ -107,16 +118,12 @@ void UFlowNode_Timer::OnCompletion()
 
 void UFlowNode_Timer::Cleanup()
 {
-	if (GetWorld())
+	if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
 	{
-		GetWorld()->GetTimerManager().ClearTimer(CompletionTimerHandle);
+		FlowSubsystem->ClearFlowTimer(CompletionTimerHandle);
+		FlowSubsystem->ClearFlowTimer(StepTimerHandle);
 	}
 	CompletionTimerHandle.Invalidate();
-
-	if (GetWorld())
-	{
-		GetWorld()->GetTimerManager().ClearTimer(StepTimerHandle);
-	}
 	StepTimerHandle.Invalidate();
 
 	SumOfSteps = 0.0f;
@@ -124,30 +131,50 @@ void UFlowNode_Timer::Cleanup()
 
 void UFlowNode_Timer::OnSave_Implementation()
 {
-	if (GetWorld())
+	if (const UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
 	{
 		if (CompletionTimerHandle.IsValid())
 		{
-			RemainingCompletionTime = GetWorld()->GetTimerManager().GetTimerRemaining(CompletionTimerHandle);
+			RemainingCompletionTime = FlowSubsystem->GetFlowTimerRemaining(CompletionTimerHandle);
 		}
 
 		if (StepTimerHandle.IsValid())
 		{
-			RemainingStepTime = GetWorld()->GetTimerManager().GetTimerRemaining(StepTimerHandle);
+			RemainingStepTime = FlowSubsystem->GetFlowTimerRemaining(StepTimerHandle);
 		}
 	}
 }
 
+bool UFlowNode_Timer::IsSaveDirty() const
+{
+	if (Super::IsSaveDirty())
+	{
+		return true;
+	}
+
+	if (const UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
+	{
+		return (CompletionTimerHandle.IsValid() && FlowSubsystem->GetFlowTimerRemaining(CompletionTimerHandle) != RemainingCompletionTime)
+			|| (StepTimerHandle.IsValid() && FlowSubsystem->GetFlowTimerRemaining(StepTimerHandle) != RemainingStepTime);
+	}
+
+	return false;
+}
+
 void UFlowNode_Timer::OnLoad_Implementation()
 {
-	if (RemainingStepTime > 0.0f || RemainingCompletionTime > 0.0f)
+	if ((RemainingStepTime > 0.0f || RemainingCompletionTime > 0.0f) && GetFlowSubsystem())
 	{
+		// timers of the paused Root Flow are restored as paused
 		if (RemainingStepTime > 0.0f)
 		{
-			GetWorld()->GetTimerManager().SetTimer(StepTimerHandle, this, &UFlowNode_Timer::OnStep, StepTime, true, RemainingStepTime);
+			SetStepTimer(RemainingStepTime);
 		}
 
-		GetWorld()->GetTimerManager().SetTimer(CompletionTimerHandle, this, &UFlowNode_Timer::OnCompletion, RemainingCompletionTime, false);
+		if (RemainingCompletionTime > 0.0f)
+		{
+			SetCompletionTimer(RemainingCompletionTime);
+		}
 
 		RemainingStepTime = 0.0f;
 		RemainingCompletionTime = 0.0f;
@@ -177,9 +204,9 @@ FString UFlowNode_Timer::GetStatusString() const
 		return FString::Printf(TEXT("Progress: %.*f"), 2, SumOfSteps);
 	}
 
-	if (CompletionTimerHandle.IsValid() && GetWorld())
+	if (CompletionTimerHandle.IsValid() && GetFlowSubsystem() && GetFlowSubsystem()->IsFlowTimerActive(CompletionTimerHandle))
 	{
-		return FString::Printf(TEXT("Progress: %.*f"), 2, GetWorld()->GetTimerManager().GetTimerElapsed(CompletionTimerHandle));
+		return FString::Printf(TEXT("Progress: %.*f"), 2, CompletionTime - GetFlowSubsystem()->GetFlowTimerRemaining(CompletionTimerHandle));
 	}
 
 	return FString();
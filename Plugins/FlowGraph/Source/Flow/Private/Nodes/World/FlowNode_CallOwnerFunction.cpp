@@ -22,6 +22,19 @@ UFlowNode_CallOwnerFunction::UFlowNode_CallOwnerFunction(const FObjectInitialize
 #endif // WITH_EDITOR
 }
 
+void UFlowNode_CallOwnerFunction::InitializeInstance()
+{
+	Super::InitializeInstance();
+
+	ValidOutputNames = GetOutputNames();
+
+	// Resolve the function early, so the first execution doesn't pay for it
+	if (const IFlowOwnerInterface* FlowOwnerInterface = GetFlowOwnerInterface())
+	{
+		(void) FunctionRef.TryResolveFunction(*CastChecked<UObject>(FlowOwnerInterface)->GetClass());
+	}
+}
+
 void UFlowNode_CallOwnerFunction::ExecuteInput(const FName& PinName)
 {
 	Super::ExecuteInput(PinName);
@@ -59,7 +72,7 @@ void UFlowNode_CallOwnerFunction::ExecuteInput(const FName& PinName)
 
 	Params->PreExecute(*this, PinName);
 
-	const FName ResultOutputName = FunctionRef.CallFunction(*FlowOwnerInterface, *Params);
+	const FName ResultOutputName = FunctionRef.CallFunction(*FlowOwnerInterface, *Params, ValidOutputNames);
 
 	Params->PostExecute();
 
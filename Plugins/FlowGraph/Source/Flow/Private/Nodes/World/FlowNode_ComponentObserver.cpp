@@ -68,10 +68,8 @@ void UFlowNode_ComponentObserver::StartObserving()
 			}
 		}
 		
-		FlowSubsystem->OnComponentRegistered.AddUniqueDynamic(this, &UFlowNode_ComponentObserver::OnComponentRegistered);
-		FlowSubsystem->OnComponentTagAdded.AddUniqueDynamic(this, &UFlowNode_ComponentObserver::OnComponentTagAdded);
-		FlowSubsystem->OnComponentTagRemoved.AddUniqueDynamic(this, &UFlowNode_ComponentObserver::OnComponentTagRemoved);
-		FlowSubsystem->OnComponentUnregistered.AddUniqueDynamic(this, &UFlowNode_ComponentObserver::OnComponentUnregistered);
+		// subsystem notifies us only about components which might match our Identity Tags
+		FlowSubsystem->SubscribeObserver(this, IdentityTags);
 	}
 }
 
@@ -79,10 +77,7 @@ void UFlowNode_ComponentObserver::StopObserving()
 {
 	if (UFlowSubsystem* FlowSubsystem = GetFlowSubsystem())
 	{
-		FlowSubsystem->OnComponentRegistered.RemoveAll(this);
-		FlowSubsystem->OnComponentUnregistered.RemoveAll(this);
-		FlowSubsystem->OnComponentTagAdded.RemoveAll(this);
-		FlowSubsystem->OnComponentTagRemoved.RemoveAll(this);
+		FlowSubsystem->UnsubscribeObserver(this);
 	}
 }
 
@@ -7,6 +7,8 @@
 #include "FlowAsset.h"
 #include "FlowLogChannels.h"
 #include "FlowSettings.h"
+#include "FlowSubsystem.h"
+#include "Types/FlowComponentPool.h"
 #include "Types/FlowInjectComponentsHelper.h"
 #include "Types/FlowInjectComponentsManager.h"
 #include "GameFramework/Actor.h"
@@ -111,6 +113,13 @@ void UFlowNode_ExecuteComponent::OnActivate()
 
 	if (UActorComponent* ResolvedComp = TryResolveComponent())
 	{
+		// deferred registration hasn't happened yet, the pool skips components registered in the meantime
+		AActor* ActorOwner = ResolvedComp->GetOwner();
+		if (bDeferComponentRegistration && !ResolvedComp->IsRegistered() && IsValid(ActorOwner))
+		{
+			FFlowInjectComponentsHelper::InjectCreatedComponent(*ActorOwner, *ResolvedComp);
+		}
+
 		if (IFlowExternalExecutableInterface* ComponentAsExternalExecutable = Cast<IFlowExternalExecutableInterface>(ResolvedComp))
 		{
 			// By convention, we must call the PreActivateExternalFlowExecutable() before OnActivate 
@@ -209,8 +218,9 @@ bool UFlowNode_ExecuteComponent::TryInjectComponent()
 		return false;
 	}
 
-	// Create the component instance
+	// Create the component instance, reusing the pooled one if possible
 	TArray<UActorComponent*> ComponentInstances;
+	UFlowComponentPool* ComponentPool = GetFlowSubsystem() ? GetFlowSubsystem()->GetComponentPool() : nullptr;
 
 	static_assert(static_cast<int32>(EExecuteComponentSource::Max) == 4, TEXT("Update this code if the enum changes"));
 	switch (ComponentSource)
@@ -219,7 +229,17 @@ bool UFlowNode_ExecuteComponent::TryInjectComponent()
 		{
 			if (IsValid(ComponentTemplate))
 			{
-				if (UActorComponent* ComponentInstance = FFlowInjectComponentsHelper::TryCreateComponentInstanceForActorFromTemplate(*ActorOwner, *ComponentTemplate))
+				// instanced template is copied to every node instance, so components are pooled by the template of the asset node
+				const UFlowNode_ExecuteComponent* TemplateNode = Cast<UFlowNode_ExecuteComponent>(GetArchetype());
+				UActorComponent* PoolKey = TemplateNode && !TemplateNode->HasAnyFlags(RF_ClassDefaultObject) && IsValid(TemplateNode->ComponentTemplate)
+					                           ? TemplateNode->ComponentTemplate.Get()
+					                           : ComponentTemplate.Get();
+
+				UActorComponent* ComponentInstance = ComponentPool
+					? ComponentPool->AcquireComponent(*ActorOwner, *ComponentTemplate, *PoolKey)
+					: FFlowInjectComponentsHelper::TryCreateComponentInstanceForActorFromTemplate(*ActorOwner, *ComponentTemplate);
+
+				if (ComponentInstance)
 				{
 					ComponentInstances.Add(ComponentInstance);
 				}
@@ -251,7 +271,11 @@ bool UFlowNode_ExecuteComponent::TryInjectComponent()
 				}
 
 				const FName InstanceBaseName = ComponentClass->GetFName();
-				if (UActorComponent* ComponentInstance = FFlowInjectComponentsHelper::TryCreateComponentInstanceForActorFromClass(*ActorOwner, *ComponentClass, InstanceBaseName))
+				UActorComponent* ComponentInstance = ComponentPool
+					? ComponentPool->AcquireComponent(*ActorOwner, ComponentClass, InstanceBaseName)
+					: FFlowInjectComponentsHelper::TryCreateComponentInstanceForActorFromClass(*ActorOwner, *ComponentClass, InstanceBaseName);
+
+				if (ComponentInstance)
 				{
 					ComponentInstances.Add(ComponentInstance);
 				}
@@ -266,7 +290,8 @@ bool UFlowNode_ExecuteComponent::TryInjectComponent()
 
 	// Create the manager object if we're injecting a component
 	InjectComponentsManager = NewObject<UFlowInjectComponentsManager>(this);
-	InjectComponentsManager->InitializeRuntime();
+	InjectComponentsManager->bDeferComponentRegistration = bDeferComponentRegistration;
+	InjectComponentsManager->InitializeRuntime(ComponentPool);
 
 	// Inject the desired component
 	if (!ComponentInstances.IsEmpty())
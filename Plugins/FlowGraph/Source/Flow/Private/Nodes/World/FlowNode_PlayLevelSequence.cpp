@@ -223,6 +223,11 @@ void UFlowNode_PlayLevelSequence::OnSave_Implementation()
 	}
 }
 
+bool UFlowNode_PlayLevelSequence::IsSaveDirty() const
+{
+	return Super::IsSaveDirty() || (SequencePlayer && SequencePlayer->GetCurrentTime().AsSeconds() != ElapsedTime);
+}
+
 void UFlowNode_PlayLevelSequence::OnLoad_Implementation()
 {
 	if (ElapsedTime != 0.0f)
@@ -254,9 +259,9 @@ void UFlowNode_PlayLevelSequence::OnLoad_Implementation()
 	}
 }
 
-void UFlowNode_PlayLevelSequence::TriggerEvent(const FString& EventName)
+void UFlowNode_PlayLevelSequence::TriggerEvent(const FName& EventName)
 {
-	TriggerOutput(*EventName, false);
+	TriggerOutput(EventName, false);
 }
 
 void UFlowNode_PlayLevelSequence::OnTimeDilationUpdate(const float NewTimeDilation)
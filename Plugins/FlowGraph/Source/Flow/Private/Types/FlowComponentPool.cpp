@@ -0,0 +1,260 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "Types/FlowComponentPool.h"
+#include "Types/FlowInjectComponentsHelper.h"
+#include "Interfaces/FlowPooledComponentInterface.h"
+#include "FlowSettings.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "TimerManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FlowComponentPool)
+
+UActorComponent* UFlowComponentPool::AcquireComponent(AActor& Actor, UActorComponent& ComponentTemplate, UObject& PoolKey)
+{
+	if (UActorComponent* PooledComponent = TakeFromPool(Actor, PoolKey, ComponentTemplate.GetFName()))
+	{
+		return PooledComponent;
+	}
+
+	UActorComponent* ComponentInstance = FFlowInjectComponentsHelper::TryCreateComponentInstanceForActorFromTemplate(Actor, ComponentTemplate);
+	return TrackCreatedComponent(ComponentInstance, PoolKey);
+}
+
+UActorComponent* UFlowComponentPool::AcquireComponent(AActor& Actor, TSubclassOf<UActorComponent> ComponentClass, const FName& InstanceBaseName)
+{
+	if (!ComponentClass)
+	{
+		return nullptr;
+	}
+
+	if (UActorComponent* PooledComponent = TakeFromPool(Actor, *ComponentClass.Get(), InstanceBaseName))
+	{
+		return PooledComponent;
+	}
+
+	UActorComponent* ComponentInstance = FFlowInjectComponentsHelper::TryCreateComponentInstanceForActorFromClass(Actor, ComponentClass, InstanceBaseName);
+	return TrackCreatedComponent(ComponentInstance, *ComponentClass.Get());
+}
+
+UActorComponent* UFlowComponentPool::TakeFromPool(AActor& Actor, UObject& PoolKey, const FName& InstanceBaseName)
+{
+	FFlowPooledComponents* Pool = Pools.Find(&PoolKey);
+	if (Pool == nullptr)
+	{
+		return nullptr;
+	}
+
+	while (Pool->Components.Num() > 0)
+	{
+		UActorComponent* ComponentInstance = Pool->Components.Pop(EAllowShrinking::No);
+		if (!IsValid(ComponentInstance))
+		{
+			continue;
+		}
+
+		Pool->Hits++;
+		AcquiredComponents.Add(ComponentInstance, &PoolKey);
+
+		// Renaming into the actor updates the component owner, as if it was created there
+		const FName UniqueName = MakeUniqueObjectName(&Actor, ComponentInstance->GetClass(), InstanceBaseName);
+		ComponentInstance->Rename(*UniqueName.ToString(), &Actor, REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional);
+
+		if (IFlowPooledComponentInterface* PooledComponentInterface = Cast<IFlowPooledComponentInterface>(ComponentInstance))
+		{
+			PooledComponentInterface->ReuseFromPool(&Actor);
+		}
+		else if (ComponentInstance->Implements<UFlowPooledComponentInterface>())
+		{
+			IFlowPooledComponentInterface::Execute_K2_ReuseFromPool(ComponentInstance, &Actor);
+		}
+
+		return ComponentInstance;
+	}
+
+	return nullptr;
+}
+
+UActorComponent* UFlowComponentPool::TrackCreatedComponent(UActorComponent* ComponentInstance, UObject& PoolKey)
+{
+	if (ComponentInstance == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (!Pools.Contains(&PoolKey))
+	{
+		RemoveStalePools();
+	}
+	Pools.FindOrAdd(&PoolKey).Misses++;
+
+	if (CanBePooled(*ComponentInstance))
+	{
+		AcquiredComponents.Add(ComponentInstance, &PoolKey);
+	}
+
+	return ComponentInstance;
+}
+
+void UFlowComponentPool::RemoveStalePools()
+{
+	for (auto It = Pools.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool UFlowComponentPool::CanBePooled(const UActorComponent& ComponentInstance)
+{
+	// Replicated components would need to be re-created on clients anyway
+	return UFlowSettings::Get()->MaxPooledComponents > 0
+		&& ComponentInstance.Implements<UFlowPooledComponentInterface>()
+		&& !ComponentInstance.GetIsReplicated();
+}
+
+void UFlowComponentPool::ReleaseComponent(AActor& Actor, UActorComponent& ComponentInstance)
+{
+	TWeakObjectPtr<UObject> PoolKey;
+	AcquiredComponents.RemoveAndCopyValue(&ComponentInstance, PoolKey);
+
+	const FFlowPooledComponents* Pool = PoolKey.IsValid() ? Pools.Find(PoolKey) : nullptr;
+	if (Pool == nullptr || Pool->Components.Num() >= UFlowSettings::Get()->MaxPooledComponents || !IsValid(&ComponentInstance) || !CanBePooled(ComponentInstance))
+	{
+		FFlowInjectComponentsHelper::DestroyInjectedComponent(Actor, ComponentInstance);
+		return;
+	}
+
+	// Following the teardown of UActorComponent::DestroyComponent(), without destroying the object
+	if (ComponentInstance.HasBegunPlay())
+	{
+		ComponentInstance.EndPlay(EEndPlayReason::RemovedFromWorld);
+	}
+
+	if (ComponentInstance.HasBeenInitialized())
+	{
+		ComponentInstance.UninitializeComponent();
+	}
+
+	if (ComponentInstance.IsRegistered())
+	{
+		ComponentInstance.UnregisterComponent();
+	}
+
+	if (USceneComponent* SceneComponentInstance = Cast<USceneComponent>(&ComponentInstance))
+	{
+		SceneComponentInstance->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+	}
+
+	if (IFlowPooledComponentInterface* PooledComponentInterface = Cast<IFlowPooledComponentInterface>(&ComponentInstance))
+	{
+		PooledComponentInterface->ResetForPool();
+	}
+	else
+	{
+		IFlowPooledComponentInterface::Execute_K2_ResetForPool(&ComponentInstance);
+	}
+
+	// Pooled component isn't owned by any actor
+	const FName UniqueName = MakeUniqueObjectName(this, ComponentInstance.GetClass(), ComponentInstance.GetClass()->GetFName());
+	ComponentInstance.Rename(*UniqueName.ToString(), this, REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional);
+
+	Pools.FindOrAdd(PoolKey).Components.Add(&ComponentInstance);
+}
+
+void UFlowComponentPool::QueueRegistration(AActor& Actor, UActorComponent& ComponentInstance)
+{
+	PendingRegistrations.Emplace(&Actor, &ComponentInstance);
+	ScheduleRegistrations(Actor.GetWorld());
+}
+
+void UFlowComponentPool::FlushPendingRegistrations()
+{
+	RegisterPendingComponents(0);
+}
+
+void UFlowComponentPool::ProcessPendingRegistrations()
+{
+	bRegistrationScheduled = false;
+
+	RegisterPendingComponents(UFlowSettings::Get()->MaxComponentRegistrationsPerFrame);
+
+	if (PendingRegistrations.Num() > 0)
+	{
+		ScheduleRegistrations(RegistrationWorld.Get());
+	}
+}
+
+void UFlowComponentPool::ScheduleRegistrations(UWorld* World)
+{
+	if (bRegistrationScheduled || World == nullptr)
+	{
+		return;
+	}
+
+	RegistrationWorld = World;
+	World->GetTimerManager().SetTimerForNextTick(this, &UFlowComponentPool::ProcessPendingRegistrations);
+	bRegistrationScheduled = true;
+}
+
+int32 UFlowComponentPool::RegisterPendingComponents(const int32 MaxRegistrations)
+{
+	int32 RegisteredNum = 0;
+
+	while (PendingRegistrations.Num() > 0 && (MaxRegistrations == 0 || RegisteredNum < MaxRegistrations))
+	{
+		const FFlowPendingComponentRegistration Pending = PendingRegistrations.PopFrontValue();
+
+		AActor* Actor = Pending.Actor.Get();
+		UActorComponent* ComponentInstance = Pending.Component.Get();
+
+		// Component might have been released or moved to another actor in the meantime
+		if (IsValid(Actor) && IsValid(ComponentInstance) && ComponentInstance->GetOwner() == Actor && !ComponentInstance->IsRegistered())
+		{
+			FFlowInjectComponentsHelper::InjectCreatedComponent(*Actor, *ComponentInstance);
+			RegisteredNum++;
+		}
+	}
+
+	return RegisteredNum;
+}
+
+FFlowComponentPoolStats UFlowComponentPool::GetStats(const UObject* ComponentTemplateOrClass) const
+{
+	FFlowComponentPoolStats Stats;
+	Stats.PendingRegistrations = PendingRegistrations.Num();
+
+	if (const FFlowPooledComponents* Pool = Pools.Find(MakeWeakObjectPtr(const_cast<UObject*>(ComponentTemplateOrClass))))
+	{
+		Stats.Hits = Pool->Hits;
+		Stats.Misses = Pool->Misses;
+		Stats.PooledComponents = Pool->Components.Num();
+	}
+
+	return Stats;
+}
+
+void UFlowComponentPool::Empty()
+{
+	Pools.Empty();
+	AcquiredComponents.Empty();
+	PendingRegistrations.Empty();
+}
+
+void UFlowComponentPool::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UFlowComponentPool* This = CastChecked<UFlowComponentPool>(InThis);
+	for (TPair<TWeakObjectPtr<UObject>, FFlowPooledComponents>& Pool : This->Pools)
+	{
+		// components of destroyed templates won't be ever reused, their pools are removed by RemoveStalePools()
+		if (Pool.Key.IsValid())
+		{
+			Collector.AddReferencedObjects(Pool.Value.Components, This);
+		}
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
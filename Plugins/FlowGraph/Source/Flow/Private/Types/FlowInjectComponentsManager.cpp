@@ -2,15 +2,18 @@
 
 #include "Types/FlowInjectComponentsManager.h"
 #include "Types/FlowInjectComponentsHelper.h"
+#include "Types/FlowComponentPool.h"
 #include "Components/ActorComponent.h"
 #include "GameFramework/Actor.h"
 #include "FlowLogChannels.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FlowInjectComponentsManager)
 
-void UFlowInjectComponentsManager::InitializeRuntime()
+void UFlowInjectComponentsManager::InitializeRuntime(UFlowComponentPool* InComponentPool)
 {
 	check(ActorToComponentsMap.IsEmpty());
+
+	ComponentPool = InComponentPool;
 }
 
 void UFlowInjectComponentsManager::ShutdownRuntime()
@@ -21,6 +24,7 @@ void UFlowInjectComponentsManager::ShutdownRuntime()
 	}
 
 	ActorToComponentsMap.Empty();
+	ComponentPool = nullptr;
 }
 
 void UFlowInjectComponentsManager::InjectComponentsOnActor(AActor& Actor, const TArray<UActorComponent*>& ComponentInstances)
@@ -58,7 +62,14 @@ void UFlowInjectComponentsManager::RemoveInjectedComponents()
 
 void UFlowInjectComponentsManager::AddAndRegisterComponent(AActor& Actor, UActorComponent& ComponentInstance)
 {
-	FFlowInjectComponentsHelper::InjectCreatedComponent(Actor, ComponentInstance);
+	if (bDeferComponentRegistration && IsValid(ComponentPool))
+	{
+		ComponentPool->QueueRegistration(Actor, ComponentInstance);
+	}
+	else
+	{
+		FFlowInjectComponentsHelper::InjectCreatedComponent(Actor, ComponentInstance);
+	}
 
 	if (bRemoveInjectedComponentsWhenDeinitializing)
 	{
@@ -77,7 +88,14 @@ void UFlowInjectComponentsManager::RemoveAndUnregisterComponent(AActor& Actor, U
 
 	UnregisterOnDestroyedDelegate(Actor);
 
-	FFlowInjectComponentsHelper::DestroyInjectedComponent(Actor, ComponentInstance);
+	if (IsValid(ComponentPool))
+	{
+		ComponentPool->ReleaseComponent(Actor, ComponentInstance);
+	}
+	else
+	{
+		FFlowInjectComponentsHelper::DestroyInjectedComponent(Actor, ComponentInstance);
+	}
 }
 
 void UFlowInjectComponentsManager::RegisterOnDestroyedDelegate(AActor& Actor)
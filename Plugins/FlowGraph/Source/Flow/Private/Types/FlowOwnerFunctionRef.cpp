@@ -6,23 +6,72 @@
 #include "FlowLogChannels.h"
 
 #include "UObject/Class.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/Stack.h"
 #include "Logging/LogMacros.h"
 
+namespace FlowOwnerFunctionRef
+{
+	// Functions resolved by all function refs, per owner class and function name
+	// Functions not found aren't cached, as these might be added by compiling the Blueprint
+	TMap<TPair<TObjectKey<UClass>, FName>, TWeakObjectPtr<UFunction>> ResolvedFunctions;
+}
+
+void FFlowOwnerFunctionRef::ResetResolvedFunctions()
+{
+	FlowOwnerFunctionRef::ResolvedFunctions.Reset();
+}
+
 UFunction* FFlowOwnerFunctionRef::TryResolveFunction(const UClass& InClass)
 {
-	if (IsConfigured())
+	if (!IsConfigured())
 	{
-		Function = InClass.FindFunctionByName(FunctionName);
+		Function = nullptr;
+		ResolvedClass = nullptr;
+		bNativeFunction = false;
+
+		return Function;
+	}
+
+	// Fast path: the same owner class as the previous call
+	if (ResolvedClass.Get() == &InClass && IsResolved())
+	{
+		return Function;
+	}
+
+	const TPair<TObjectKey<UClass>, FName> CacheKey(TObjectKey<UClass>(&InClass), FunctionName);
+	const TWeakObjectPtr<UFunction>* CachedFunction = FlowOwnerFunctionRef::ResolvedFunctions.Find(CacheKey);
+
+	if (CachedFunction && CachedFunction->IsValid())
+	{
+		Function = CachedFunction->Get();
 	}
 	else
 	{
-		Function = nullptr;
+		Function = InClass.FindFunctionByName(FunctionName);
+		if (Function)
+		{
+			FlowOwnerFunctionRef::ResolvedFunctions.Add(CacheKey, Function.Get());
+		}
 	}
 
+	ResolvedClass = &InClass;
+
+	// Remote functions have to go through ProcessEvent
+	bNativeFunction = IsResolved()
+		&& Function->HasAnyFunctionFlags(FUNC_Native)
+		&& !Function->HasAnyFunctionFlags(FUNC_Net)
+		&& Function->ReturnValueOffset != MAX_uint16;
+
 	return Function;
 }
 
 FName FFlowOwnerFunctionRef::CallFunction(IFlowOwnerInterface& InFlowOwnerInterface, UFlowOwnerFunctionParams& InParams) const
+{
+	return CallFunction(InFlowOwnerInterface, InParams, InParams.GatherOutputNames());
+}
+
+FName FFlowOwnerFunctionRef::CallFunction(IFlowOwnerInterface& InFlowOwnerInterface, UFlowOwnerFunctionParams& InParams, const TArray<FName>& ValidOutputNames) const
 {
 	if (!IsResolved())
 	{
@@ -52,17 +101,24 @@ FName FFlowOwnerFunctionRef::CallFunction(IFlowOwnerInterface& InFlowOwnerInterf
 	FFlowOwnerFunctionRef_Parms Parms = { &InParams, NAME_None };
 
 	// Call the owner function itself
-	FlowOwnerObject->ProcessEvent(Function, &Parms);
+	if (bNativeFunction)
+	{
+		// The same as ProcessEvent does for native functions, without its bookkeeping
+		FFrame Stack(FlowOwnerObject, Function, &Parms, nullptr, Function->ChildProperties);
+		Function->Invoke(FlowOwnerObject, Stack, reinterpret_cast<uint8*>(&Parms) + Function->ReturnValueOffset);
+	}
+	else
+	{
+		FlowOwnerObject->ProcessEvent(Function, &Parms);
+	}
 
 	// Ensure the return value is valid
 	if (!Parms.OutputPinName.IsNone())
 	{
-		const TArray<FName> OutputNames = InParams.GatherOutputNames();
-
-		if (!OutputNames.Contains(Parms.OutputPinName))
+		if (!ValidOutputNames.Contains(Parms.OutputPinName))
 		{
 			FString OutputNamesStr = TEXT("None");
-			for (const FName& OutputName : OutputNames)
+			for (const FName& OutputName : ValidOutputNames)
 			{
 				OutputNamesStr += TEXT(", ") + OutputName.ToString();
 			}
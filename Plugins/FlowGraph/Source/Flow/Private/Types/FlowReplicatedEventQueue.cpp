@@ -0,0 +1,93 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "Types/FlowReplicatedEventQueue.h"
+#include "FlowComponent.h"
+#include "FlowLogChannels.h"
+#include "FlowSettings.h"
+
+#include "Algo/Sort.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FlowReplicatedEventQueue)
+
+void FFlowReplicatedEventQueue::Enqueue(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags, const FGameplayTag& ActorTag, const double ServerTime)
+{
+	// events enqueued in the current frame haven't been sent yet, so the latest one can still be extended
+	// repeated tag starts a new event, as clients should receive every notify
+	if (Events.Num() > 0)
+	{
+		FFlowReplicatedEvent& LastEvent = Events.Last();
+		if (LastEvent.FrameNumber == GFrameCounter && LastEvent.Type == Type && LastEvent.ActorTag == ActorTag && !LastEvent.Tags.HasAnyExact(Tags))
+		{
+			LastEvent.Tags.AppendTags(Tags);
+			MarkItemDirty(LastEvent);
+			return;
+		}
+	}
+
+	FFlowReplicatedEvent& NewEvent = Events.AddDefaulted_GetRef();
+	NewEvent.Sequence = NextSequence++;
+	NewEvent.Type = Type;
+	NewEvent.Tags = Tags;
+	NewEvent.ActorTag = ActorTag;
+	NewEvent.ServerTime = ServerTime;
+	NewEvent.FrameNumber = GFrameCounter;
+	MarkItemDirty(NewEvent);
+
+	// dropping the oldest events keeps the bandwidth bounded, even if the burst doesn't end
+	const int32 MaxEvents = FMath::Max(UFlowSettings::Get()->MaxReplicatedEvents, 1);
+	if (Events.Num() > MaxEvents)
+	{
+		Events.RemoveAt(0, Events.Num() - MaxEvents, EAllowShrinking::No);
+		MarkArrayDirty();
+	}
+}
+
+bool FFlowReplicatedEventQueue::RemoveExpiredEvents(const double ServerTime, const double RetentionTime)
+{
+	// events are sorted by the time of sending
+	int32 ExpiredNum = 0;
+	while (ExpiredNum < Events.Num() && ServerTime - Events[ExpiredNum].ServerTime >= RetentionTime)
+	{
+		ExpiredNum++;
+	}
+
+	if (ExpiredNum > 0)
+	{
+		Events.RemoveAt(0, ExpiredNum, EAllowShrinking::No);
+		MarkArrayDirty();
+	}
+
+	return Events.Num() > 0;
+}
+
+void FFlowReplicatedEventQueue::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, const int32 FinalSize)
+{
+	if (Owner == nullptr)
+	{
+		return;
+	}
+
+	TArray<const FFlowReplicatedEvent*, TInlineAllocator<8>> NewEvents;
+	for (const int32 Index : AddedIndices)
+	{
+		if (Events.IsValidIndex(Index) && Events[Index].Sequence > LastAppliedSequence)
+		{
+			NewEvents.Add(&Events[Index]);
+		}
+	}
+
+	// added indices don't follow the order of sending
+	Algo::SortBy(NewEvents, [](const FFlowReplicatedEvent* Event) { return Event->Sequence; });
+
+	for (const FFlowReplicatedEvent* Event : NewEvents)
+	{
+		if (LastAppliedSequence > 0 && Event->Sequence > LastAppliedSequence + 1)
+		{
+			UE_LOG(LogFlow, Verbose, TEXT("Flow Component in actor %s missed %u replicated events, these were dropped from the queue before replicating"),
+			       *GetNameSafe(Owner->GetOwner()), Event->Sequence - LastAppliedSequence - 1);
+		}
+
+		LastAppliedSequence = Event->Sequence;
+		Owner->ApplyReplicatedEvent(*Event);
+	}
+}
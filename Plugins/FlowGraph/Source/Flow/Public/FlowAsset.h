@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "FlowCompiledGraph.h"
 #include "FlowSave.h"
 #include "FlowTypes.h"
 #include "Nodes/FlowNode.h"
@@ -17,6 +18,7 @@ class UFlowNode_CustomOutput;
 class UFlowNode_CustomInput;
 class UFlowNode_SubGraph;
 class UFlowSubsystem;
+struct FStreamableHandle;
 
 class UEdGraph;
 class UEdGraphNode;
@@ -65,6 +67,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Flow Asset")
 	bool bWorldBound;
 
+	// UObject
+	virtual void PostLoad() override;
+	// --
+
 //////////////////////////////////////////////////////////////////////////
 // Graph
 
@@ -76,7 +82,6 @@ public:
 	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 	virtual void PostDuplicate(bool bDuplicateForPIE) override;
-	virtual void PostLoad() override;
 	// --
 
 public:
@@ -131,6 +136,12 @@ private:
 	UPROPERTY()
 	TMap<FGuid, UFlowNode*> Nodes;
 
+	// Flat graph compiled from the template nodes, instances share the graph of their template
+	TSharedPtr<const FFlowCompiledGraph> CompiledGraph;
+
+	// Node instances ordered by the index of the compiled graph, filled only on instances
+	TArray<UFlowNode*> IndexedNodes;
+
 #if WITH_EDITORONLY_DATA
 protected:
 	/**
@@ -162,14 +173,53 @@ public:
 #endif
 
 	const TMap<FGuid, UFlowNode*>& GetNodes() const { return Nodes; }
-	UFlowNode* GetNode(const FGuid& Guid) const { return Nodes.FindRef(Guid); }
+
+	// Tests build transient graphs in code, otherwise nodes are added only by the graph editor
+	void AddNode_ForTesting(UFlowNode* NewNode) { Nodes.Add(NewNode->GetGuid(), NewNode); }
+
+	// Returns output pins (node guid and pin name) connected to the given input pin
+	TConstArrayView<FConnectedPin> GetInputConnections(const FGuid& NodeGuid, const FName& PinName) const;
+
+	const FFlowCompiledGraph* GetCompiledGraph() const { return CompiledGraph.Get(); }
+
+	// Returns the node instance, or the read-only template node if the node hasn't been instanced yet
+	UFlowNode* GetNodeByIndex(const int32 NodeIndex) const;
+
+	// Returns the node instance owned by this asset instance, creating it if the node hasn't been instanced yet
+	// Use these while preloading or triggering nodes of instances with bLazyNodeInstancing enabled
+	UFlowNode* GetNodeInstance(const FGuid& NodeGuid);
+	UFlowNode* GetNodeInstanceByIndex(const int32 NodeIndex);
+
+protected:
+	// Recompiles the flat graph, has to be called after any change to nodes, their pins or Connections
+	void CompileGraph();
+
+public:
+	// Returns the node instance, creating it if the node of the lazy instance hasn't been instanced yet
+	UFlowNode* GetNode(const FGuid& Guid) { return GetNodeInstance(Guid); }
+
+	// Read-only access, returns the template node if the node of the lazy instance hasn't been instanced yet
+	const UFlowNode* GetNode(const FGuid& Guid) const { return Nodes.FindRef(Guid); }
+
+	template <class T>
+	T* GetNode(const FGuid& Guid)
+	{
+		static_assert(TPointerIsConvertibleFromTo<T, const UFlowNode>::Value, "'T' template parameter to GetNode must be derived from UFlowNode");
+
+		if (UFlowNode* Node = GetNodeInstance(Guid))
+		{
+			return Cast<T>(Node);
+		}
+
+		return nullptr;
+	}
 
 	template <class T>
-	T* GetNode(const FGuid& Guid) const
+	const T* GetNode(const FGuid& Guid) const
 	{
 		static_assert(TPointerIsConvertibleFromTo<T, const UFlowNode>::Value, "'T' template parameter to GetNode must be derived from UFlowNode");
 
-		if (UFlowNode* Node = Nodes.FindRef(Guid))
+		if (const UFlowNode* Node = Nodes.FindRef(Guid))
 		{
 			return Cast<T>(Node);
 		}
@@ -206,8 +256,10 @@ protected:
 			OutNodes.Emplace(NodeOfRequiredType);
 		}
 
-		for (UFlowNode* ConnectedNode : Node->GetConnectedNodes())
+		// iterating doesn't instance nodes of the lazy instance, so the node can be the read-only template node
+		for (const TPair<FName, FConnectedPin>& Connection : Node->Connections)
 		{
+			UFlowNode* ConnectedNode = Nodes.FindRef(Connection.Value.NodeGuid);
 			if (ConnectedNode && !IteratedNodes.Contains(ConnectedNode))
 			{
 				GetNodesInExecutionOrder_Recursive(ConnectedNode, IteratedNodes, OutNodes);
@@ -257,6 +309,25 @@ public:
 	void ClearInstances();
 	int32 GetInstancesNum() const { return ActiveInstances.Num(); }
 
+	// If enabled, finished instances of this asset are reset and reused by the Flow Subsystem instead of creating new objects
+	// Useful for short-lived graphs started very often, i.e. per interaction
+	// Properties of nodes and asset subclasses are restored from the template, other runtime state should be restored by overriding ResetInstance()
+	UPROPERTY(EditAnywhere, Category = "Instance Pool")
+	bool bPoolInstances;
+
+	// Maximum number of finished instances kept for reuse
+	UPROPERTY(EditAnywhere, Category = "Instance Pool", meta = (EditCondition = "bPoolInstances", ClampMin = 1))
+	int32 InstancePoolSize;
+
+	// Number of instances created in advance, while this asset is instanced for the first time
+	UPROPERTY(EditAnywhere, Category = "Instance Pool", meta = (EditCondition = "bPoolInstances", ClampMin = 0))
+	int32 InstancePoolPrewarmCount;
+
+	// If enabled, instances create node instances only when the node is triggered or preloaded for the first time
+	// Until then, read-only accessors like GetNodeByIndex() return the template node, so big graphs pay only for nodes actually used
+	UPROPERTY(EditAnywhere, Category = "Instance")
+	bool bLazyNodeInstancing;
+
 #if WITH_EDITOR
 	void GetInstanceDisplayNames(TArray<TSharedPtr<FName>>& OutDisplayNames) const;
 
@@ -292,30 +363,49 @@ protected:
 	// SubGraph node that created this Flow Asset instance
 	TWeakObjectPtr<UFlowNode_SubGraph> NodeOwningThisAssetInstance;
 
+	// Assets loaded for the instance started asynchronously, kept in memory until the flow finishes
+	TArray<TSharedPtr<FStreamableHandle>> LoadHandles;
+
 	// Flow Asset instances created by SubGraph nodes placed in the current graph
 	TMap<TWeakObjectPtr<UFlowNode_SubGraph>, TWeakObjectPtr<UFlowAsset>> ActiveSubGraphs;
 
-	// Optional entry points to the graph, similar to blueprint Custom Events
-	UPROPERTY()
-	TSet<UFlowNode_CustomInput*> CustomInputNodes;
-
 	UPROPERTY()
 	TSet<UFlowNode*> PreloadedNodes;
 
 	// Nodes that have any work left, not marked as Finished yet
+	// Finishing node leaves an empty slot, so the execution order is kept without shifting the array
+	// Empty slots are removed by CompactActiveNodes()
 	UPROPERTY()
 	TArray<UFlowNode*> ActiveNodes;
 
+	// Number of valid entries in ActiveNodes
+	int32 ActiveNodesNum;
+
 	// All nodes active in the past, done their work
 	UPROPERTY()
 	TArray<UFlowNode*> RecordedNodes;
 
 	EFlowFinishPolicy FinishPolicy;
 
+	// Set on the Root Flow instance, pauses Flow Timers of this instance and its Sub Flows
+	UPROPERTY(SaveGame)
+	bool bFlowTimersPaused;
+
 public:
 	virtual void InitializeInstance(const TWeakObjectPtr<UObject> InOwner, UFlowAsset* InTemplateAsset);
 	virtual void DeinitializeInstance();
 
+	// Restores state of the finished instance, so it can be kept by the instance pool (see bPoolInstances)
+	virtual void ResetInstance();
+
+	// Initializes instance taken from the instance pool for the new owner
+	virtual void ReinitializeInstance(const TWeakObjectPtr<UObject> InOwner);
+
+private:
+	// Duplicates the template node, replacing it in Nodes of this instance
+	UFlowNode* CreateNodeInstance(const int32 NodeIndex);
+
+public:
 	UFlowAsset* GetTemplateAsset() const { return TemplateAsset; }
 
 	// Object that spawned Root Flow instance, i.e. World Settings or Player Controller
@@ -333,7 +423,7 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Flow")
 	AActor* TryFindActorOwner() const;
 
-	// Opportunity to preload content of project-specific nodes
+	// Opportunity to preload content of project-specific nodes, GetNodeInstance() provides nodes of the lazy instance
 	virtual void PreloadNodes() {}
 
 	virtual void PreStartFlow();
@@ -353,10 +443,23 @@ protected:
 
 	void TriggerInput(const FGuid& NodeGuid, const FName& PinName);
 
+	// Routes signal to the node input, either directly or through the Flow Subsystem queue (see UFlowSettings::bQueuedExecution)
+	void TriggerInput(UFlowNode* Node, const uint16 InputPinIndex);
+
+	// Delivers signal to the node input immediately
+	void ExecuteTriggerInput(UFlowNode* Node, const uint16 InputPinIndex);
+
 	void FinishNode(UFlowNode* Node);
 	void ResetNodes();
 
+	void AddActiveNode(UFlowNode* Node);
+	bool RemoveActiveNode(UFlowNode* Node);
+	void CompactActiveNodes();
+
 public:
+	// Tests measure routing of signals without the node triggering its output
+	void TriggerInput_ForTesting(UFlowNode* Node, const uint16 InputPinIndex) { TriggerInput(Node, InputPinIndex); }
+
 	UFlowSubsystem* GetFlowSubsystem() const;
 	FName GetDisplayName() const;
 
@@ -365,11 +468,12 @@ public:
 
 	// Are there any active nodes?
 	UFUNCTION(BlueprintPure, Category = "Flow")
-	bool IsActive() const { return ActiveNodes.Num() > 0; }
+	bool IsActive() const { return ActiveNodesNum > 0; }
 
 	// Returns nodes that have any work left, not marked as Finished yet
+	// Non-const, as empty slots left by finished nodes are removed before returning the array
 	UFUNCTION(BlueprintPure, Category = "Flow")
-	const TArray<UFlowNode*>& GetActiveNodes() const { return ActiveNodes; }
+	const TArray<UFlowNode*>& GetActiveNodes();
 
 	// Returns nodes active in the past, done their work
 	UFUNCTION(BlueprintPure, Category = "Flow")
@@ -395,9 +499,35 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SaveGame")
 	FFlowAssetSaveData SaveInstance(TArray<FFlowAssetSaveData>& SavedFlowInstances);
 
+	// Reuses records from the Baseline for this instance and its nodes, if these haven't changed since the previous save
+	FFlowAssetSaveData SaveInstanceIncremental(TArray<FFlowAssetSaveData>& SavedFlowInstances, FFlowSaveBaseline& Baseline);
+
 	UFUNCTION(BlueprintCallable, Category = "SaveGame")
 	void LoadInstance(const FFlowAssetSaveData& AssetRecord);
 
+	// Incremental save serializes this instance only if it's marked dirty or any of its active nodes is dirty
+	// Node changes mark the instance automatically, call it after changing SaveGame properties of the asset
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	void MarkSaveDirty() { bSaveDirty = true; }
+
+	bool IsSaveDirty() const;
+
+	// Calls OnSave() on the clean instance opted in by bAlwaysCallOnSave, marks it dirty if its SaveGame state changed since the previous save
+	void UpdateSaveDirty();
+
+	// Enable it if OnSave() captures state without marking the instance dirty, i.e. in Blueprint
+	// Incremental save calls OnSave() then also on the clean instance and reuses its record only if the saved data didn't change
+	UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SaveGame")
+	bool bAlwaysCallOnSave;
+
+private:
+	FFlowAssetSaveData SaveInstanceInternal(TArray<FFlowAssetSaveData>& SavedFlowInstances, FFlowSaveBaseline* Baseline);
+
+	bool bSaveDirty;
+
+	// CRC of SaveGame state written by the previous save, used only with bAlwaysCallOnSave
+	uint32 SaveDataHash;
+
 protected:
 	virtual void OnActivationStateLoaded(UFlowNode* Node);
 
@@ -0,0 +1,108 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Nodes/FlowPin.h"
+
+class UFlowNode;
+
+/* Output pin connected to the input pin of another node, both addressed by indices of the compiled graph */
+struct FFlowCompiledRoute
+{
+	int32 NodeIndex;
+	uint16 InputPinIndex;
+
+	FFlowCompiledRoute()
+		: NodeIndex(INDEX_NONE)
+		, InputPinIndex(MAX_uint16)
+	{
+	}
+
+	bool IsConnected() const { return NodeIndex != INDEX_NONE; }
+};
+
+/* Node of the compiled graph, its pins are ranges of the flat arrays of FFlowCompiledGraph */
+struct FFlowCompiledNode
+{
+	FGuid NodeGuid;
+
+	// Routes of output pins, ordered by the output pin index
+	int32 FirstRoute;
+	int32 OutputPinsNum;
+
+	// Input pins in the CSR index of input connections, ordered by the input pin index
+	int32 FirstInputPin;
+	int32 InputPinsNum;
+
+	TMap<FName, uint16> InputPinIndices;
+	TMap<FName, uint16> OutputPinIndices;
+
+	FFlowCompiledNode()
+		: FirstRoute(0)
+		, OutputPinsNum(0)
+		, FirstInputPin(0)
+		, InputPinsNum(0)
+	{
+	}
+};
+
+/**
+ * Flat representation of the node graph, compiled once per template asset and shared by all its instances
+ * - nodes are addressed by the index, the instance keeps its node instances in the same order
+ * - outputs are routed through the contiguous array of routes, without searching maps of connections
+ * - input connections are stored in the CSR form: offsets per input pin into the single array of connected output pins
+ * - entry points (Start node, Custom Inputs) and Custom Outputs are indexed by the event name
+ * Graph is immutable, recompiling the template creates a new one, so running instances keep using the graph they were created with
+ */
+struct FLOW_API FFlowCompiledGraph
+{
+	FFlowCompiledGraph()
+		: EntryNodeIndex(INDEX_NONE)
+	{
+	}
+
+	static TSharedRef<const FFlowCompiledGraph> Compile(const TMap<FGuid, UFlowNode*>& TemplateNodes);
+
+	int32 Num() const { return Nodes.Num(); }
+
+	const FFlowCompiledNode& GetNode(const int32 NodeIndex) const { check(Nodes.IsValidIndex(NodeIndex)); return Nodes[NodeIndex]; }
+
+	/* Returns INDEX_NONE if node doesn't belong to this graph */
+	int32 FindNodeIndex(const FGuid& NodeGuid) const;
+
+	/* Returns UFlowNode::InvalidPinIndex if node doesn't have such pin or the node index is invalid */
+	uint16 FindInputPinIndex(const int32 NodeIndex, const FName& PinName) const;
+	uint16 FindOutputPinIndex(const int32 NodeIndex, const FName& PinName) const;
+
+	/* Returns nullptr if the node index is invalid or the output pin index is out of range of the compiled node */
+	const FFlowCompiledRoute* FindRoute(const int32 NodeIndex, const uint16 OutputPinIndex) const;
+
+	/* Returns output pins of other nodes (node guid and pin name) connected to the given input pin, empty view for invalid indices */
+	TConstArrayView<FConnectedPin> GetInputConnections(const int32 NodeIndex, const uint16 InputPinIndex) const;
+
+	/* Start node with connected output, otherwise the first Start node, INDEX_NONE if graph has no Start node */
+	int32 GetEntryNodeIndex() const { return EntryNodeIndex; }
+
+	/* Custom Input nodes with the given event name, in the order of template nodes */
+	TConstArrayView<int32> FindCustomInputNodes(const FName& EventName) const;
+
+	/* Returns INDEX_NONE if graph has no Custom Output node with the given event name */
+	int32 FindCustomOutputNode(const FName& EventName) const;
+
+private:
+	TArray<FFlowCompiledNode> Nodes;
+	TMap<FGuid, int32> NodeIndices;
+
+	TArray<FFlowCompiledRoute> Routes;
+
+	// Input pin at FirstInputPin + pin index owns connections from InputConnectionOffsets[Pin] to InputConnectionOffsets[Pin + 1]
+	TArray<int32> InputConnectionOffsets;
+	TArray<FConnectedPin> InputConnections;
+
+	int32 EntryNodeIndex;
+	TMap<FName, TArray<int32>> CustomInputNodeIndices;
+	TMap<FName, int32> CustomOutputNodeIndices;
+
+	bool HasConnectedOutput(const int32 NodeIndex) const;
+};
@@ -8,31 +8,12 @@
 #include "FlowSave.h"
 #include "FlowTypes.h"
 #include "Interfaces/FlowOwnerInterface.h"
+#include "Types/FlowReplicatedEventQueue.h"
 #include "FlowComponent.generated.h"
 
 class UFlowAsset;
 class UFlowSubsystem;
 
-USTRUCT()
-struct FNotifyTagReplication
-{
-	GENERATED_BODY()
-
-	UPROPERTY()
-	FGameplayTag ActorTag;
-
-	UPROPERTY()
-	FGameplayTag NotifyTag;
-
-	FNotifyTagReplication() {}
-
-	FNotifyTagReplication(const FGameplayTag& InActorTag, const FGameplayTag& InNotifyTag)
-		: ActorTag(InActorTag)
-		, NotifyTag(InNotifyTag)
-	{
-	}
-};
-
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFlowComponentTagsReplicated, class UFlowComponent*, FlowComponent, const FGameplayTagContainer&, CurrentTags);
 
 DECLARE_MULTICAST_DELEGATE_TwoParams(FFlowComponentNotify, class UFlowComponent*, const FGameplayTag&);
@@ -47,24 +28,44 @@ class FLOW_API UFlowComponent : public UActorComponent, public IFlowOwnerInterfa
 	GENERATED_UCLASS_BODY()
 
 	friend class UFlowSubsystem;
+	friend struct FFlowReplicatedEventQueue;
 	
+	virtual void PostInitProperties() override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	// Identity tags changes and notifies sent by the server, in the order of sending
+	UPROPERTY(Replicated)
+	FFlowReplicatedEventQueue ReplicatedEvents;
+
+	FTimerHandle ReplicatedEventsExpirationHandle;
+
+	void EnqueueReplicatedEvent(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags, const FGameplayTag& ActorTag = FGameplayTag());
+	void RemoveExpiredReplicatedEvents();
+
+	// Called on clients for every event received from the server
+	void ApplyReplicatedEvent(const FFlowReplicatedEvent& Event);
+
+	// Runtime changes of identity tags, sent only with the initial replication
+	UPROPERTY(ReplicatedUsing = OnRep_IdentityTagsDelta)
+	FFlowIdentityTagsDelta IdentityTagsDelta;
+
+	// Server-only, called after changing identity tags
+	void UpdateIdentityTagsDelta(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags);
+
+	UFUNCTION()
+	void OnRep_IdentityTagsDelta();
+
+	// Applies identity tags change received from the server, skipping tags which were already applied
+	void ApplyReplicatedIdentityTags(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags);
 	
 //////////////////////////////////////////////////////////////////////////
 // Identity Tags
 
+public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Flow")
 	FGameplayTagContainer IdentityTags;
 
-private:
-	// Used to replicate tags added during gameplay
-	UPROPERTY(ReplicatedUsing = OnRep_AddedIdentityTags)
-	FGameplayTagContainer AddedIdentityTags;
-
-	// Used to replicate tags removed during gameplay
-	UPROPERTY(ReplicatedUsing = OnRep_RemovedIdentityTags)
-	FGameplayTagContainer RemovedIdentityTags;
-
 public:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
@@ -86,13 +87,6 @@ protected:
 	void UnregisterWithFlowSubsystem();
 	virtual void BeginRootFlow(bool bComponentLoadedFromSaveGame);
 
-private:
-	UFUNCTION()
-	void OnRep_AddedIdentityTags();
-
-	UFUNCTION()
-	void OnRep_RemovedIdentityTags();
-
 public:
 	UPROPERTY(BlueprintAssignable, Category = "Flow")
 	FFlowComponentTagsReplicated OnIdentityTagsAdded;
@@ -111,7 +105,6 @@ public:
 
 private:
 	// Stores only recently sent tags
-	UPROPERTY(ReplicatedUsing = OnRep_SentNotifyTags)
 	FGameplayTagContainer RecentlySentNotifyTags;
 
 public:
@@ -128,8 +121,7 @@ public:
 	void BulkNotifyGraph(const FGameplayTagContainer NotifyTags, const EFlowNetMode NetMode = EFlowNetMode::Authority);
 
 private:
-	UFUNCTION()
-	void OnRep_SentNotifyTags();
+	void BroadcastSentNotifyTags();
 
 public:
 	FFlowComponentNotify OnNotifyFromComponent;
@@ -137,19 +129,10 @@ public:
 //////////////////////////////////////////////////////////////////////////
 // Component receiving Notify Tags from Flow Graph
 
-private:
-	// Stores only recently replicated tags
-	UPROPERTY(ReplicatedUsing = OnRep_NotifyTagsFromGraph)
-	FGameplayTagContainer NotifyTagsFromGraph;
-
 public:
 	virtual void NotifyFromGraph(const FGameplayTagContainer& NotifyTags, const EFlowNetMode NetMode = EFlowNetMode::Authority);
 
-private:
-	UFUNCTION()
-	void OnRep_NotifyTagsFromGraph();
 
-public:
 	// Receive notification from Flow graph or another Flow Component
 	UPROPERTY(BlueprintAssignable, Category = "Flow")
 	FFlowComponentDynamicNotify ReceiveNotify;
@@ -157,20 +140,11 @@ public:
 //////////////////////////////////////////////////////////////////////////
 // Sending Notify Tags between Flow components
 
-private:
-	// Stores only recently replicated tags
-	UPROPERTY(ReplicatedUsing = OnRep_NotifyTagsFromAnotherComponent)
-	TArray<FNotifyTagReplication> NotifyTagsFromAnotherComponent;
-
 public:
 	// Send notification to another actor containing Flow Component
 	UFUNCTION(BlueprintCallable, Category = "Flow")
 	virtual void NotifyActor(const FGameplayTag ActorTag, const FGameplayTag NotifyTag, const EFlowNetMode NetMode = EFlowNetMode::Authority);
 
-private:
-	UFUNCTION()
-	void OnRep_NotifyTagsFromAnotherComponent();
-
 //////////////////////////////////////////////////////////////////////////
 // Root Flow
 
@@ -230,6 +204,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SaveGame")
 	virtual void SaveRootFlow(TArray<FFlowAssetSaveData>& SavedFlowInstances);
 
+	// Reuses records from the Baseline for the root flow and its nodes, if these haven't changed since the previous save
+	virtual void SaveRootFlowIncremental(TArray<FFlowAssetSaveData>& SavedFlowInstances, FFlowSaveBaseline& Baseline);
+
 	UFUNCTION(BlueprintCallable, Category = "SaveGame")
 	virtual void LoadRootFlow();
 
@@ -239,6 +216,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SaveGame")
 	bool LoadInstance();
 
+	// Incremental save serializes only components marked dirty since the previous save
+	// Call it after changing SaveGame properties of the component
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	void MarkSaveDirty() { bSaveDirty = true; }
+
+	bool IsSaveDirty() const { return bSaveDirty; }
+
+	// Calls OnSave() on the clean component opted in by bAlwaysCallOnSave, marks it dirty if its SaveGame state changed since the previous save
+	void UpdateSaveDirty();
+
+	// Enable it if OnSave() captures state without marking the component dirty, i.e. in Blueprint
+	// Incremental save calls OnSave() then also on the clean component and reuses its record only if the saved data didn't change
+	UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "SaveGame")
+	bool bAlwaysCallOnSave;
+
+private:
+	bool bSaveDirty;
+
+	// CRC of SaveGame state written by the previous save, used only with bAlwaysCallOnSave
+	uint32 SaveDataHash;
+
 protected:
 	UFUNCTION(BlueprintNativeEvent, Category = "SaveGame")
 	void OnSave();
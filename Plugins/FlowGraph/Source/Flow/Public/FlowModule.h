@@ -9,4 +9,7 @@ class FFlowModule final : public IModuleInterface
 public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	FDelegateHandle ObjectsReinstancedHandle;
 };
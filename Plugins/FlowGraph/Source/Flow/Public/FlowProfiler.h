@@ -0,0 +1,121 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "UObject/ObjectKey.h"
+
+class UFlowAsset;
+class UFlowNode;
+
+// In-process aggregation of node execution times, reported by the Flow.Profiler.Report command
+// Available in every build except Shipping, so Test builds can attribute frames to specific graphs
+#ifndef WITH_FLOW_PROFILER
+#define WITH_FLOW_PROFILER !UE_BUILD_SHIPPING
+#endif
+
+DECLARE_STATS_GROUP(TEXT("Flow"), STATGROUP_Flow, STATCAT_Advanced);
+
+// Every node class gets its own cycle counter in this group
+DECLARE_STATS_GROUP(TEXT("Flow Nodes"), STATGROUP_FlowNodes, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trigger Input"), STAT_FlowTriggerInput, STATGROUP_Flow, FLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trigger Output"), STAT_FlowTriggerOutput, STATGROUP_Flow, FLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create Flow Instance"), STAT_FlowCreateInstance, STATGROUP_Flow, FLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Finish Flow"), STAT_FlowFinishFlow, STATGROUP_Flow, FLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Save"), STAT_FlowSave, STATGROUP_Flow, FLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load"), STAT_FlowLoad, STATGROUP_Flow, FLOW_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Executed Inputs"), STAT_FlowExecutedInputs, STATGROUP_Flow, FLOW_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triggered Outputs"), STAT_FlowTriggeredOutputs, STATGROUP_Flow, FLOW_API);
+
+// Enable with -trace=cpu,flow to see node execution spans, signals and instance lifetime in Unreal Insights
+UE_TRACE_CHANNEL_EXTERN(FlowChannel, FLOW_API);
+
+// Span traced on the Flow channel, i.e. save or load
+#define FLOW_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, FlowChannel)
+
+// Trace events of the Flow channel, these do nothing if the channel isn't enabled
+struct FLOW_API FFlowTrace
+{
+	static void OutputSignal(const UFlowNode& FromNode, const FName& OutputPinName, const UFlowNode& ToNode, const FName& InputPinName);
+	static void OutputInstanceCreated(const UFlowAsset& Instance);
+	static void OutputInstanceFinished(const UFlowAsset& Instance);
+};
+
+#if WITH_FLOW_PROFILER
+struct FFlowProfilerEntry
+{
+	FString Name;
+	int64 Calls = 0;
+
+	// Including nodes executed synchronously by this one
+	uint64 InclusiveCycles = 0;
+	uint64 ExclusiveCycles = 0;
+};
+
+/**
+ * Lightweight aggregator of node execution, collecting calls and time per node class and per Flow Asset
+ * - enabled by the Flow.Profiler.Enabled console variable
+ * - nested executions are tracked on a stack, so exclusive time isn't counted twice
+ */
+class FLOW_API FFlowProfiler
+{
+public:
+	static FFlowProfiler& Get();
+	static bool IsEnabled();
+
+	void BeginNode(const UFlowNode& Node);
+	void EndNode();
+
+	// Writes the hottest node classes and assets, sorted by exclusive time
+	void Report(FOutputDevice& Ar, const int32 MaxEntries) const;
+	void Reset();
+
+	const TMap<FObjectKey, FFlowProfilerEntry>& GetNodeClassEntries() const { return NodeClassEntries; }
+	const TMap<FObjectKey, FFlowProfilerEntry>& GetAssetEntries() const { return AssetEntries; }
+
+private:
+	struct FStackFrame
+	{
+		FObjectKey NodeClass;
+		FObjectKey Asset;
+		uint64 StartCycles;
+		uint64 ChildCycles;
+	};
+
+	TArray<FStackFrame> Stack;
+
+	TMap<FObjectKey, FFlowProfilerEntry> NodeClassEntries;
+	TMap<FObjectKey, FFlowProfilerEntry> AssetEntries;
+
+	static void ReportEntries(FOutputDevice& Ar, const TCHAR* Title, const TMap<FObjectKey, FFlowProfilerEntry>& Entries, const int32 MaxEntries);
+};
+#endif
+
+/**
+ * Measures execution of the single node input
+ * Feeds the per-class cycle counter, the node span on the Flow trace channel and the profiler
+ */
+class FLOW_API FFlowNodeExecutionScope
+{
+public:
+	explicit FFlowNodeExecutionScope(const UFlowNode& Node);
+	~FFlowNodeExecutionScope();
+
+private:
+#if STATS
+	FScopeCycleCounter NodeClassCycleCounter;
+#endif
+
+#if CPUPROFILERTRACE_ENABLED
+	bool bTraced;
+#endif
+
+#if WITH_FLOW_PROFILER
+	bool bProfiled;
+#endif
+};
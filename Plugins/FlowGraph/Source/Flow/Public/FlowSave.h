@@ -3,9 +3,72 @@
 #pragma once
 
 #include "GameFramework/SaveGame.h"
+#include "Misc/Guid.h"
 #include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/SoftObjectPath.h"
 #include "FlowSave.generated.h"
 
+class UFlowSaveGame;
+struct FFlowRecordTables;
+
+/* Version of the Flow save data, stored in UFlowSaveGame and every record
+ * Serialize() of nodes and components can check it with Ar.CustomVer(FFlowSaveVersion::GUID) while loading */
+struct FLOW_API FFlowSaveVersion
+{
+	enum Type
+	{
+		// Records saved before the version was stored
+		LegacyRecords = 0,
+
+		// Records store the schema version and might be compressed
+		VersionedRecords,
+
+		// Records might store names and object paths as indices to tables of UFlowSaveGame
+		NameTableRecords,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+/* Optional compression of the serialized record data, configured in UFlowSettings */
+struct FLOW_API FFlowSaveCompression
+{
+	/* Replaces data with its compressed version, if compression is enabled and reduces the size
+	 * OutCompressionFormat is None if data has been left uncompressed */
+	static void Compress(TArray<uint8>& InOutData, FName& OutCompressionFormat, int32& OutUncompressedSize);
+
+	/* Returns data ready for reading: either the record data or Buffer filled with decompressed data
+	 * Returns nullptr if decompression failed */
+	static const TArray<uint8>* Decompress(const TArray<uint8>& Data, const FName CompressionFormat, const int32 UncompressedSize, TArray<uint8>& Buffer);
+};
+
+struct FLOW_API FFlowSaveSerialization
+{
+	/* Serializes SaveGame properties of the object with FFlowArchive and compresses the result, if enabled */
+	static void SerializeObject(UObject* Object, TArray<uint8>& OutData, FName& OutCompressionFormat, int32& OutUncompressedSize);
+
+	/* Serializes SaveGame properties of the object with FFlowArchive, without compression
+	 * Parallel save compression calls it on the game thread and compresses the result on worker threads, so results are identical to the serial save */
+	static void SerializeObjectUncompressed(UObject* Object, TArray<uint8>& OutData);
+
+	/* Serializes SaveGame properties of the object with FFlowTableArchive, without compression
+	 * Data is valid only after merging OutTables into the SaveGame with UFlowSaveGame::MergeRecordTables */
+	static void SerializeObjectWithTables(UObject* Object, TArray<uint8>& OutData, FFlowRecordTables& OutTables);
+
+	/* Returns CRC of SaveGame properties of the object, serialized with SerializeObjectUncompressed
+	 * Incremental save uses it to detect changes of objects with bAlwaysCallOnSave, which capture state in OnSave() without marking themselves dirty */
+	static uint32 HashObject(UObject* Object);
+
+	/* Decompresses record data and deserializes it with the archive matching the record encoding
+	 * SaveGame provides name and object path tables, it's required only by records with bNameTableEncoding */
+	static bool DeserializeObject(UObject* Object, const TArray<uint8>& Data, const FName CompressionFormat, const int32 UncompressedSize,
+	                              const int32 SchemaVersion, const bool bNameTableEncoding, const UFlowSaveGame* SaveGame);
+};
+
 USTRUCT(BlueprintType)
 struct FLOW_API FFlowNodeSaveData
 {
@@ -17,6 +80,23 @@ struct FLOW_API FFlowNodeSaveData
 	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
 	TArray<uint8> NodeData;
 
+	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
+	int32 SchemaVersion = FFlowSaveVersion::LegacyRecords;
+
+	// None if NodeData isn't compressed
+	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
+	FName CompressionFormat;
+
+	UPROPERTY(SaveGame)
+	int32 UncompressedSize = 0;
+
+	// Names and object references are stored as indices to UFlowSaveGame tables
+	UPROPERTY(SaveGame)
+	bool bNameTableEncoding = false;
+
+	// Index of the serialization deferred by the save, INDEX_NONE if data is already written
+	int32 PendingSerialization = INDEX_NONE;
+
 	friend FArchive& operator<<(FArchive& Ar, FFlowNodeSaveData& InNodeData)
 	{
 		return Ar;
@@ -37,6 +117,23 @@ struct FLOW_API FFlowAssetSaveData
 	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
 	TArray<uint8> AssetData;
 
+	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
+	int32 SchemaVersion = FFlowSaveVersion::LegacyRecords;
+
+	// None if AssetData isn't compressed
+	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
+	FName CompressionFormat;
+
+	UPROPERTY(SaveGame)
+	int32 UncompressedSize = 0;
+
+	// Names and object references are stored as indices to UFlowSaveGame tables
+	UPROPERTY(SaveGame)
+	bool bNameTableEncoding = false;
+
+	// Index of the serialization deferred by the save, INDEX_NONE if data is already written
+	int32 PendingSerialization = INDEX_NONE;
+
 	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
 	TArray<FFlowNodeSaveData> NodeRecords;
 
@@ -60,20 +157,94 @@ struct FLOW_API FFlowComponentSaveData
 	UPROPERTY(SaveGame)
 	TArray<uint8> ComponentData;
 
+	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
+	int32 SchemaVersion = FFlowSaveVersion::LegacyRecords;
+
+	// None if ComponentData isn't compressed
+	UPROPERTY(SaveGame, VisibleAnywhere, Category = "Flow")
+	FName CompressionFormat;
+
+	UPROPERTY(SaveGame)
+	int32 UncompressedSize = 0;
+
+	// Names and object references are stored as indices to UFlowSaveGame tables
+	UPROPERTY(SaveGame)
+	bool bNameTableEncoding = false;
+
+	// Index of the serialization deferred by the save, INDEX_NONE if data is already written
+	int32 PendingSerialization = INDEX_NONE;
+
 	friend FArchive& operator<<(FArchive& Ar, FFlowComponentSaveData& InComponentData)
 	{
 		return Ar;
 	}
 };
 
+/* Records of the current world taken from the previous save
+ * Incremental save reuses them for Flow Assets, nodes and components which haven't changed since then */
+struct FLOW_API FFlowSaveBaseline
+{
+	// Keyed by InstanceName
+	TMap<FString, FFlowAssetSaveData> FlowInstances;
+
+	// Keyed by ActorInstanceName
+	TMap<FString, FFlowComponentSaveData> FlowComponents;
+};
+
 struct FLOW_API FFlowArchive : public FObjectAndNameAsStringProxyArchive
 {
-	FFlowArchive(FArchive& InInnerArchive) : FObjectAndNameAsStringProxyArchive(InInnerArchive, true)
+	FFlowArchive(FArchive& InInnerArchive, const int32 SchemaVersion = FFlowSaveVersion::LatestVersion) : FObjectAndNameAsStringProxyArchive(InInnerArchive, true)
 	{
 		ArIsSaveGame = true;
+
+		// custom versions are read from the inner archive
+		InInnerArchive.SetCustomVersion(FFlowSaveVersion::GUID, SchemaVersion, TEXT("FlowSave"));
 	}
 };
 
+/* Names and object paths referenced by the single record, merged into UFlowSaveGame tables after serialization
+ * Records are serialized independently, possibly on worker threads, so they can't write to the shared tables directly */
+struct FLOW_API FFlowRecordTables
+{
+	TArray<FName> Names;
+	TArray<FSoftObjectPath> ObjectPaths;
+
+	// Positions of the indices in the record data, rewritten to indices of the SaveGame tables while merging
+	TArray<int64> NameOffsets;
+	TArray<int64> ObjectPathOffsets;
+
+	int32 AddName(const FName& Name);
+	int32 AddObjectPath(const FSoftObjectPath& ObjectPath);
+
+	void Reset();
+
+private:
+	TMap<FName, int32> NameIndices;
+	TMap<FSoftObjectPath, int32> ObjectPathIndices;
+};
+
+/* Writes names and object references as indices to tables stored once per UFlowSaveGame, instead of repeating strings in every record
+ * Used if UFlowSettings::bSaveNameTables is enabled, records written by FFlowArchive remain readable */
+struct FLOW_API FFlowTableArchive : public FArchiveProxy
+{
+	// Saving into record tables
+	FFlowTableArchive(FArchive& InInnerArchive, FFlowRecordTables& InRecordTables);
+
+	// Loading with tables of the SaveGame
+	FFlowTableArchive(FArchive& InInnerArchive, const UFlowSaveGame& InSaveGame, const int32 SchemaVersion);
+
+	virtual FArchive& operator<<(FName& Value) override;
+	virtual FArchive& operator<<(UObject*& Value) override;
+	virtual FArchive& operator<<(FWeakObjectPtr& Value) override;
+	virtual FArchive& operator<<(FSoftObjectPtr& Value) override;
+	virtual FArchive& operator<<(FSoftObjectPath& Value) override;
+	virtual FArchive& operator<<(FObjectPtr& Value) override;
+
+private:
+	FFlowRecordTables* RecordTables;
+	const UFlowSaveGame* SaveGame;
+};
+
 UCLASS(BlueprintType)
 class FLOW_API UFlowSaveGame : public USaveGame
 {
@@ -85,11 +256,23 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "SaveGame")
 	FString SaveSlotName = TEXT("FlowSave");
 
+	// Version of the Flow save data, LegacyRecords if the save has been created before versioning
+	UPROPERTY(VisibleAnywhere, Category = "SaveGame")
+	int32 SaveVersion = FFlowSaveVersion::LegacyRecords;
+
 	UPROPERTY(VisibleAnywhere, Category = "Flow")
 	TArray<FFlowComponentSaveData> FlowComponents;
 
 	UPROPERTY(VisibleAnywhere, Category = "Flow")
 	TArray<FFlowAssetSaveData> FlowInstances;
+
+	// Names referenced by records with bNameTableEncoding, shared by all records of this save
+	UPROPERTY(VisibleAnywhere, Category = "Flow")
+	TArray<FName> NameTable;
+
+	// Object paths referenced by records with bNameTableEncoding, shared by all records of this save
+	UPROPERTY(VisibleAnywhere, Category = "Flow")
+	TArray<FSoftObjectPath> ObjectPathTable;
 	
 	friend FArchive& operator<<(FArchive& Ar, UFlowSaveGame& SaveGame)
 	{
@@ -97,4 +280,36 @@ public:
 		Ar << SaveGame.FlowInstances;
 		return Ar;
 	}
+
+	/* Returns the first record of given Flow Asset instance, or nullptr */
+	const FFlowAssetSaveData* FindFlowInstance(const FString& WorldName, const FString& InstanceName) const;
+
+	/* Returns the first record of given Flow Component owner, or nullptr */
+	const FFlowComponentSaveData* FindFlowComponent(const FString& WorldName, const FString& ActorInstanceName) const;
+
+	/* Lookup tables are rebuilt on the next search
+	 * Call it after modifying FlowComponents or FlowInstances, if records could be added and removed in equal numbers */
+	void InvalidateRecordIndex();
+
+	/* Adds names and object paths of the record to the tables of this save, then rewrites record indices to point at these tables
+	 * Tables are only appended, so records kept from previous saves remain valid */
+	void MergeRecordTables(const FFlowRecordTables& RecordTables, TArray<uint8>& RecordData);
+
+private:
+	/* Lookups of NameTable and ObjectPathTable entries, built on demand */
+	TMap<FName, int32> NameTableIndices;
+	TMap<FSoftObjectPath, int32> ObjectPathTableIndices;
+
+
+	/* Indices of records by the hash of world and instance name, built on demand */
+	mutable TMultiMap<uint32, int32> FlowComponentIndex;
+	mutable TMultiMap<uint32, int32> FlowInstanceIndex;
+	mutable bool bRecordIndexValid = false;
+
+	void BuildRecordIndex() const;
+
+	static uint32 GetRecordHash(const FString& WorldName, const FString& InstanceName)
+	{
+		return HashCombine(GetTypeHash(WorldName), GetTypeHash(InstanceName));
+	}
 };
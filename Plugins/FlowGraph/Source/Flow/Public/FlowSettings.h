@@ -28,9 +28,47 @@ class FLOW_API UFlowSettings : public UDeveloperSettings
 	UPROPERTY(Config, EditAnywhere, Category = "Networking")
 	bool bCreateFlowSubsystemOnClients;
 
+	// Flow Component keeps at most this many identity tags changes and notifies waiting for replication
+	// The oldest ones are dropped first, so the bandwidth stays bounded during a long burst
+	UPROPERTY(Config, EditAnywhere, Category = "Networking", meta = (ClampMin = 1))
+	int32 MaxReplicatedEvents;
+
+	// How long identity tags changes and notifies are kept for replication, should cover the slowest net update of the component
+	UPROPERTY(Config, EditAnywhere, Category = "Networking", meta = (ClampMin = 0.1f, Units = "s"))
+	float ReplicatedEventsRetentionTime;
+
 	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem")
 	bool bWarnAboutMissingIdentityTags;
 
+	// If enabled, serialized data of Flow Assets, nodes and components is compressed in the SaveGame
+	// Saves created with compression disabled remain readable, and the other way round
+	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem")
+	bool bCompressSaveData;
+
+	// Compression format used for save data, i.e. Oodle or Zlib
+	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem", meta = (EditCondition = "bCompressSaveData"))
+	FName SaveDataCompressionFormat;
+
+	// Records smaller than this are stored uncompressed, as compressing them wouldn't pay off
+	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem", meta = (EditCondition = "bCompressSaveData", ClampMin = 0, Units = "Bytes"))
+	int32 MinCompressedRecordSize;
+
+	// If enabled, Flow Subsystem compresses save records on worker threads, objects are still serialized on the game thread
+	// Output is identical to the serial save, it has no effect if save data isn't compressed
+	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem", meta = (EditCondition = "bCompressSaveData"))
+	bool bParallelSaveCompression;
+
+	// Saves with fewer records are compressed on the game thread, as it wouldn't pay off to involve workers
+	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem", meta = (EditCondition = "bCompressSaveData && bParallelSaveCompression", ClampMin = 1))
+	int32 MinParallelSaveRecords;
+
+	bool IsParallelSaveCompressionEnabled() const { return bCompressSaveData && bParallelSaveCompression; }
+
+	// If enabled, names and object paths are written once per SaveGame to shared tables and save records store only indices
+	// Records saved as plain strings remain readable, so this can be toggled without invalidating older saves
+	UPROPERTY(Config, EditAnywhere, Category = "SaveSystem")
+	bool bSaveNameTables;
+
 	// If enabled, runtime logs will be added when a flow node signal mode is set to Disabled
 	UPROPERTY(Config, EditAnywhere, Category = "Flow")
 	bool bLogOnSignalDisabled;
@@ -39,6 +77,39 @@ class FLOW_API UFlowSettings : public UDeveloperSettings
 	UPROPERTY(Config, EditAnywhere, Category = "Flow")
 	bool bLogOnSignalPassthrough;
 
+	// Number of recent activations recorded per node pin for debugging purposes, the oldest records are overwritten
+	// Records aren't kept in Shipping builds or if FLOW_WITH_PIN_RECORDS is defined as 0
+	UPROPERTY(Config, EditAnywhere, Category = "Flow", meta = (ClampMin = 1))
+	int32 MaxPinRecords;
+
+	// If enabled, signals between nodes are pushed to the Flow Subsystem queue and delivered iteratively
+	// This prevents deep native call stacks on long chains of nodes and allows to limit work done per frame
+	UPROPERTY(Config, EditAnywhere, Category = "Execution")
+	bool bQueuedExecution;
+
+	// Maximum number of queued signals delivered in a single frame, 0 means no limit
+	UPROPERTY(Config, EditAnywhere, Category = "Execution", meta = (EditCondition = "bQueuedExecution", ClampMin = 0))
+	int32 MaxQueuedSignalsPerFrame;
+
+	// Time budget (in milliseconds) for delivering queued signals in a single frame, 0 means no limit
+	// Budget is checked between signals, so a single expensive node can exceed it
+	UPROPERTY(Config, EditAnywhere, Category = "Execution", meta = (EditCondition = "bQueuedExecution", ClampMin = 0.0f, Units = "ms"))
+	float QueuedSignalsTimeBudget;
+
+	// Duration of a single tick of Flow Timers, see UFlowSubsystem::SetFlowTimer
+	// All timers due within the same tick are called together, so a coarser resolution means fewer updates and less precise timers
+	UPROPERTY(Config, EditAnywhere, Category = "Execution", meta = (ClampMin = 0.001f, Units = "s"))
+	float FlowTimerResolution;
+
+	// Maximum number of removed injected components kept for reuse, per component template or class, 0 disables pooling
+	// Only components implementing FlowPooledComponentInterface are pooled, as these can reset their state
+	UPROPERTY(Config, EditAnywhere, Category = "Execution", meta = (ClampMin = 0))
+	int32 MaxPooledComponents;
+
+	// Maximum number of injected components registered in a single frame, if the registration is deferred, 0 means no limit
+	UPROPERTY(Config, EditAnywhere, Category = "Execution", meta = (ClampMin = 0))
+	int32 MaxComponentRegistrationsPerFrame;
+
 	// Adjust the Titles for FlowNodes to be more expressive than default
 	// by incorporating data that would otherwise go in the Description
 	UPROPERTY(EditAnywhere, config, Category = "Nodes")
@@ -2,14 +2,23 @@
 
 #pragma once
 
+#include "Containers/RingBuffer.h"
+#include "Engine/StreamableManager.h"
+#include "Templates/Function.h"
 #include "GameFramework/Actor.h"
 #include "GameplayTagContainer.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 
 #include "FlowComponent.h"
+#include "FlowTimerWheel.h"
+#include "Types/FlowComponentPool.h"
 #include "FlowSubsystem.generated.h"
 
 class UFlowAsset;
+class UFlowComponentPool;
+class UFlowNode;
+class UFlowNodeBase;
+class UFlowNode_ComponentObserver;
 class UFlowNode_SubGraph;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FSimpleFlowEvent);
@@ -18,6 +27,125 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FTaggedFlowComponentEvent, UFlowCom
 
 DECLARE_DELEGATE_OneParam(FNativeFlowAssetEvent, class UFlowAsset*);
 
+/* Signal waiting for delivery to the node input, used if UFlowSettings::bQueuedExecution is enabled */
+struct FFlowQueuedSignal
+{
+	TWeakObjectPtr<UFlowAsset> FlowInstance;
+
+	// Node owned by the FlowInstance, valid as long as the instance is valid
+	UFlowNode* Node;
+	uint16 InputPinIndex;
+
+	FFlowQueuedSignal(UFlowAsset* InFlowInstance, UFlowNode* InNode, const uint16 InInputPinIndex)
+		: FlowInstance(InFlowInstance)
+		, Node(InNode)
+		, InputPinIndex(InInputPinIndex)
+	{
+	}
+};
+
+/* Record serialization deferred until all records of the save are built
+ * See UFlowSettings::bParallelSaveCompression and UFlowSettings::bSaveNameTables */
+struct FFlowDeferredSerialization
+{
+	UObject* Object;
+
+	// Bound to the record data once all records are in the final place
+	TArray<uint8>* Data;
+	FName* CompressionFormat;
+	int32* UncompressedSize;
+	bool* bNameTableEncoding;
+
+	explicit FFlowDeferredSerialization(UObject* InObject)
+		: Object(InObject)
+		, Data(nullptr)
+		, CompressionFormat(nullptr)
+		, UncompressedSize(nullptr)
+		, bNameTableEncoding(nullptr)
+	{
+	}
+};
+
+/* Streamable handles keeping assets loaded for the pending flow in memory, until the flow instance takes them over */
+typedef TArray<TSharedPtr<FStreamableHandle>> FFlowLoadHandles;
+
+/* Root Flow waiting for its asset to load, see UFlowSubsystem::StartRootFlowAsync */
+struct FFlowPendingRootFlow
+{
+	TWeakObjectPtr<UObject> Owner;
+	FSoftObjectPath AssetPath;
+	TSharedRef<FFlowLoadHandles> LoadHandles;
+
+	FFlowPendingRootFlow(UObject* InOwner, const FSoftObjectPath& InAssetPath)
+		: Owner(InOwner)
+		, AssetPath(InAssetPath)
+		, LoadHandles(MakeShared<FFlowLoadHandles>())
+	{
+	}
+};
+
+/* Sub Graph node waiting for its asset to load, see UFlowSubsystem::CreateSubFlowAsync */
+struct FFlowPendingSubFlow
+{
+	// Custom inputs triggered on the node in the meantime
+	TArray<FName> QueuedInputs;
+	TSharedRef<FFlowLoadHandles> LoadHandles;
+
+	FFlowPendingSubFlow()
+		: LoadHandles(MakeShared<FFlowLoadHandles>())
+	{
+	}
+};
+
+/* Finished instances of the single template kept for reuse, see UFlowAsset::bPoolInstances */
+USTRUCT()
+struct FFlowInstancePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UFlowAsset*> Instances;
+
+	int32 Hits;
+	int32 Misses;
+
+	FFlowInstancePool()
+		: Hits(0)
+		, Misses(0)
+	{
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FLOW_API FFlowInstancePoolStats
+{
+	GENERATED_BODY()
+
+	// Number of instances taken from the pool
+	UPROPERTY(BlueprintReadOnly, Category = "FlowSubsystem")
+	int32 Hits;
+
+	// Number of instances created, because the pool was empty
+	UPROPERTY(BlueprintReadOnly, Category = "FlowSubsystem")
+	int32 Misses;
+
+	// Number of currently active instances of the template
+	UPROPERTY(BlueprintReadOnly, Category = "FlowSubsystem")
+	int32 LiveInstances;
+
+	// Number of finished instances waiting for reuse
+	UPROPERTY(BlueprintReadOnly, Category = "FlowSubsystem")
+	int32 PooledInstances;
+
+	FFlowInstancePoolStats()
+		: Hits(0)
+		, Misses(0)
+		, LiveInstances(0)
+		, PooledInstances(0)
+	{
+	}
+};
+
 /**
  * Flow Subsystem
  * - manages lifetime of Flow Graphs
@@ -39,16 +167,38 @@ public:
 private:
 	/* All asset templates with active instances */
 	UPROPERTY()
-	TArray<UFlowAsset*> InstancedTemplates;
+	TSet<UFlowAsset*> InstancedTemplates;
 
 	/* Assets instanced by object from another system, i.e. World Settings or Player Controller */
 	UPROPERTY()
 	TMap<UFlowAsset*, TWeakObjectPtr<UObject>> RootInstances;
 
+	/* Indexes of RootInstances, updated only by AddRootInstance/RemoveRootInstance */
+	TMap<TWeakObjectPtr<UObject>, TSet<UFlowAsset*>> RootInstancesByOwner;
+	TMap<UFlowAsset*, TSet<UFlowAsset*>> RootInstancesByTemplate;
+
 	/* Assets instanced by Sub Graph nodes */
 	UPROPERTY()
 	TMap<UFlowNode_SubGraph*, UFlowAsset*> InstancedSubFlows;
 
+	/* Finished instances kept for reuse, per template asset */
+	UPROPERTY()
+	TMap<UFlowAsset*, FFlowInstancePool> InstancePools;
+
+	/* Components injected by nodes, kept for reuse */
+	UPROPERTY()
+	UFlowComponentPool* ComponentPool;
+
+	FStreamableManager StreamableManager;
+
+	/* Root Flows waiting for the asset load, by request id
+	 * Finishing root flows of the owner removes the request, so it won't start after the load */
+	TMap<uint32, FFlowPendingRootFlow> PendingRootFlows;
+	uint32 NextPendingRootFlowId;
+
+	/* Sub Graph nodes waiting for the asset load, with custom inputs triggered in the meantime */
+	TMap<TWeakObjectPtr<UFlowNode_SubGraph>, FFlowPendingSubFlow> PendingSubFlows;
+
 #if WITH_EDITOR
 public:
 	/* Called after creating the first instance of given Flow Asset */
@@ -77,6 +227,12 @@ public:
 
 	virtual UFlowAsset* CreateRootFlow(UObject* Owner, UFlowAsset* FlowAsset, const bool bAllowMultipleInstances = true);
 
+	/* Loads the asset asynchronously and starts the root Flow afterwards, avoiding a hitch if the asset isn't loaded yet
+	 * bLoadReferencedAssets also loads assets referenced by nodes, including Sub Graph assets and their references
+	 * OnStarted is called with the new instance, or with nullptr if the flow couldn't be started or has been finished before the load completed */
+	virtual void StartRootFlowAsync(UObject* Owner, const TSoftObjectPtr<UFlowAsset>& FlowAsset, const bool bAllowMultipleInstances = true, const bool bLoadReferencedAssets = false,
+	                                FNativeFlowAssetEvent OnStarted = FNativeFlowAssetEvent());
+
 	/* Finish Policy value is read by Flow Node
 	 * Nodes have opportunity to terminate themselves differently if Flow Graph has been aborted
 	 * Example: Spawn node might despawn all actors if Flow Graph is aborted, not completed */
@@ -89,11 +245,39 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem", meta = (DefaultToSelf = "Owner"))
 	virtual void FinishAllRootFlows(UObject* Owner, const EFlowFinishPolicy FinishPolicy);
 
+	/* Finishes all Root Flows instanced by any of given owners, i.e. actors from the level being streamed out
+	 * Finish Policy value is read by Flow Node */
+	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem")
+	virtual void FinishRootFlowsForOwners(const TArray<UObject*>& Owners, const EFlowFinishPolicy FinishPolicy);
+
 protected:
+	void AddRootInstance(UFlowAsset* Instance, UObject* Owner);
+	void RemoveRootInstance(UFlowAsset* Instance);
+
 	UFlowAsset* CreateSubFlow(UFlowNode_SubGraph* SubGraphNode, const FString SavedInstanceName = FString(), const bool bPreloading = false);
 	void RemoveSubFlow(UFlowNode_SubGraph* SubGraphNode, const EFlowFinishPolicy FinishPolicy);
 
+	/* Creates Sub Flow immediately if the asset is loaded, otherwise loads it with its referenced assets asynchronously */
+	void CreateSubFlowAsync(UFlowNode_SubGraph* SubGraphNode);
+
+	/* Custom input triggered on the Sub Graph node, while its asset is still loading, will be delivered after starting the Sub Flow
+	 * Returns false if there's no pending load for this node */
+	bool QueuePendingSubFlowInput(UFlowNode_SubGraph* SubGraphNode, const FName& EventName);
+
+	bool IsSubFlowPending(const UFlowNode_SubGraph* SubGraphNode) const;
+
+	/* Loads given assets, optionally followed by assets referenced by nodes of loaded Flow Assets, then calls OnLoaded
+	 * Handles of all requested loads are added to LoadHandles, loading stops early if the caller has released LoadHandles */
+	void RequestFlowAssetsLoad(const TArray<FSoftObjectPath>& AssetPaths, const bool bLoadReferencedAssets, const TSharedRef<FFlowLoadHandles> LoadHandles, TFunction<void()>&& OnLoaded);
+	static void GatherReferencedAssets(const UFlowAsset* Template, TArray<FSoftObjectPath>& OutAssetPaths);
+
 	UFlowAsset* CreateFlowInstance(const TWeakObjectPtr<UObject> Owner, TSoftObjectPtr<UFlowAsset> FlowAsset, FString NewInstanceName = FString());
+	UFlowAsset* NewFlowInstance(UFlowAsset* Template, const TWeakObjectPtr<UObject> Owner, FString NewInstanceName);
+
+	/* Instance pool, used by assets with bPoolInstances enabled */
+	UFlowAsset* AcquirePooledInstance(UFlowAsset* Template, const TWeakObjectPtr<UObject> Owner);
+	void ReleaseFlowInstance(UFlowAsset* Instance);
+	void PrewarmInstancePool(UFlowAsset* Template, FFlowInstancePool& Pool);
 
 	virtual void AddInstancedTemplate(UFlowAsset* Template);
 	virtual void RemoveInstancedTemplate(UFlowAsset* Template);
@@ -107,9 +291,23 @@ public:
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
 	TSet<UFlowAsset*> GetRootInstancesByOwner(const UObject* Owner) const;
 
+	/* Returns all Root Flow instances of given asset */
+	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
+	TSet<UFlowAsset*> GetRootInstancesByTemplate(const UFlowAsset* TemplateAsset) const;
+
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeprecatedFunction, DeprecationMessage="Use GetRootInstancesByOwner() instead."))
 	UFlowAsset* GetRootFlow(const UObject* Owner) const;
 
+	/* Returns statistics of the instance pool for given asset, see UFlowAsset::bPoolInstances */
+	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
+	FFlowInstancePoolStats GetInstancePoolStats(const UFlowAsset* TemplateAsset) const;
+
+	UFlowComponentPool* GetComponentPool() const { return ComponentPool; }
+
+	/* Returns statistics of the component pool for given component template or class, see UFlowSettings::MaxPooledComponents */
+	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
+	FFlowComponentPoolStats GetComponentPoolStats(const UObject* ComponentTemplateOrClass) const;
+
 	/* Returns assets instanced by Sub Graph nodes */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
 	const TMap<UFlowNode_SubGraph*, UFlowAsset*>& GetInstancedSubFlows() const { return InstancedSubFlows; }
@@ -125,6 +323,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem")
 	virtual void OnGameSaved(UFlowSaveGame* SaveGame);
 
+	/* Serializes only Flow Assets, nodes and components changed since the previous save, keeping other records of the SaveGame
+	 * Save cost depends on the amount of changes, not the size of the world
+	 * Falls back to the full save if the previous save has been written to a different SaveGame */
+	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem")
+	virtual void OnGameSavedIncremental(UFlowSaveGame* SaveGame);
+
 	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem")
 	virtual void OnGameLoaded(UFlowSaveGame* SaveGame);
 
@@ -137,6 +341,97 @@ public:
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
 	UFlowSaveGame* GetLoadedSaveGame() const { return LoadedSaveGame; }
 
+protected:
+	/* Writes records of the current world, reusing unchanged records from the Baseline if provided */
+	void SaveRecords(UFlowSaveGame* SaveGame, FFlowSaveBaseline* Baseline);
+
+	/* SaveGame written by the previous save, the only one which can be updated incrementally */
+	TWeakObjectPtr<UFlowSaveGame> IncrementalSaveGame;
+
+	/* Serializations collected during the save with bParallelSaveCompression or bSaveNameTables enabled */
+	TArray<FFlowDeferredSerialization> DeferredSerializations;
+	bool bDeferringSerialization;
+
+	void BindDeferredSerialization(int32& PendingSerialization, TArray<uint8>& Data, FName& CompressionFormat, int32& UncompressedSize, bool& bNameTableEncoding);
+	void ExecuteDeferredSerializations(UFlowSaveGame* SaveGame);
+
+public:
+	/* Returns true if serialization of the object will be executed later, after building all records of the save
+	 * OutPendingSerialization needs to be stored in the record, so data can be written there */
+	bool DeferSerialization(UObject* Object, int32& OutPendingSerialization);
+
+//////////////////////////////////////////////////////////////////////////
+// Queued execution
+
+private:
+	/* Signals waiting for delivery, the first element is delivered next */
+	TRingBuffer<FFlowQueuedSignal> SignalQueue;
+
+	/* Signals sent while delivering the current signal, moved to the front of queue afterwards
+	 * This keeps the depth-first order of synchronous execution */
+	TArray<FFlowQueuedSignal> SentSignals;
+
+	bool bDeliveringSignals;
+	bool bSignalDeliveryScheduled;
+
+	uint64 SignalBudgetFrame;
+	int32 SignalsDeliveredThisFrame;
+	double SignalSecondsThisFrame;
+
+public:
+	/* Adds signal to the queue and delivers queued signals, as long as the frame budget allows it */
+	void QueueSignal(UFlowAsset* FlowInstance, UFlowNode* Node, const uint16 InputPinIndex);
+
+	/* Removes all signals queued for given Flow Asset instance, i.e. after finishing the instance */
+	void DiscardQueuedSignals(const UFlowAsset* FlowInstance);
+
+	int32 GetQueuedSignalsNum() const { return SignalQueue.Num() + SentSignals.Num(); }
+
+protected:
+	void DeliverQueuedSignals();
+	bool IsSignalBudgetExceeded() const;
+
+//////////////////////////////////////////////////////////////////////////
+// Flow Timers
+
+private:
+	/* Timers of all Flow Graph instances, advanced by a single world timer running only while any timer is scheduled */
+	FFlowTimerWheel TimerWheel;
+	FTimerHandle TimerWheelTickHandle;
+
+	/* Duration of the wheel tick, captured from UFlowSettings::FlowTimerResolution on initialization */
+	float TimerWheelResolution;
+
+public:
+	/* Calls Delegate after Delay seconds, and then every Interval seconds if it's greater than 0
+	 * Time is counted in ticks of UFlowSettings::FlowTimerResolution, so Delay is rounded up to the next tick
+	 * Timer belongs to the Root Flow of the node and is paused together with other timers of this Root Flow
+	 * Returns invalid handle if there's no world */
+	FFlowTimerHandle SetFlowTimer(const UFlowNodeBase* Node, FFlowTimerDelegate Delegate, const float Delay, const float Interval = 0.0f);
+	void ClearFlowTimer(FFlowTimerHandle& Handle);
+
+	bool IsFlowTimerActive(const FFlowTimerHandle& Handle) const;
+
+	/* Time left until the next call of the timer delegate, frozen while timers are paused */
+	float GetFlowTimerRemaining(const FFlowTimerHandle& Handle) const;
+
+	/* Pauses timers of the Root Flow and all its Sub Flows, including timers set later
+	 * Pause state is saved with the Root Flow instance */
+	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem")
+	void PauseFlowTimers(UFlowAsset* RootFlow);
+
+	UFUNCTION(BlueprintCallable, Category = "FlowSubsystem")
+	void UnpauseFlowTimers(UFlowAsset* RootFlow);
+
+	UFUNCTION(BlueprintPure, Category = "FlowSubsystem")
+	bool AreFlowTimersPaused(const UFlowAsset* RootFlow) const;
+
+	int32 GetFlowTimersNum() const { return TimerWheel.Num(); }
+
+protected:
+	void TickTimerWheel();
+	void UpdateTimerWheelTicking();
+
 //////////////////////////////////////////////////////////////////////////
 // Component Registry
 
@@ -144,6 +439,23 @@ protected:
 	/* All the Flow Components currently existing in the world */
 	TMultiMap<FGameplayTag, TWeakObjectPtr<UFlowComponent>> FlowComponentRegistry;
 
+	/* Flow Components registered under every Identity Tag and all its parent tags
+	 * Value of the inner map is the number of component's Identity Tags matching the bucket tag
+	 * Used by non-exact queries, so these don't need to iterate the entire registry */
+	TMap<FGameplayTag, TMap<TWeakObjectPtr<UFlowComponent>, int32>> FlowComponentTagIndex;
+
+	void AddToTagIndex(UFlowComponent* Component, const FGameplayTag& Tag);
+	void RemoveFromTagIndex(UFlowComponent* Component, const FGameplayTag& Tag);
+
+	/* Component Observers subscribed to components identified by given tag */
+	TMultiMap<FGameplayTag, TWeakObjectPtr<UFlowNode_ComponentObserver>> ObserversByTag;
+
+	/* Identity Tags used to subscribe given Component Observer */
+	TMap<TWeakObjectPtr<UFlowNode_ComponentObserver>, FGameplayTagContainer> ObserverSubscriptions;
+
+	/* Calls Notify on every subscribed observer which could match the component, either by its current Identity Tags or tags from the event */
+	void NotifyObservers(UFlowComponent* Component, const FGameplayTagContainer& EventTags, TFunctionRef<void(UFlowNode_ComponentObserver*)> Notify);
+
 protected:
 	virtual void RegisterComponent(UFlowComponent* Component);
 	virtual void OnIdentityTagAdded(UFlowComponent* Component, const FGameplayTag& AddedTag);
@@ -172,12 +484,17 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "FlowSubsystem")
 	FTaggedFlowComponentEvent OnComponentTagRemoved;
 
+	/* Observer will be notified about registration and Identity Tag changes only of components identified by given tags
+	 * Cheaper than binding to the multicast events above, as events of other components don't reach the observer */
+	void SubscribeObserver(UFlowNode_ComponentObserver* Observer, const FGameplayTagContainer& IdentityTags);
+	void UnsubscribeObserver(UFlowNode_ComponentObserver* Observer);
+
 	/**
 	 * Returns all registered Flow Components identified by given tag
 	 * 
 	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
 	 * @param ComponentClass Only components matching this class we'll be returned
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeterminesOutputType = "ComponentClass"))
 	TSet<UFlowComponent*> GetFlowComponentsByTag(const FGameplayTag Tag, const TSubclassOf<UFlowComponent> ComponentClass, const bool bExactMatch = true) const;
@@ -188,7 +505,7 @@ public:
 	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
 	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
 	 * @param ComponentClass Only components matching this class we'll be returned
-	* @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	* @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeterminesOutputType = "ComponentClass"))
 	TSet<UFlowComponent*> GetFlowComponentsByTags(const FGameplayTagContainer Tags, const EGameplayContainerMatchType MatchType, const TSubclassOf<UFlowComponent> ComponentClass, const bool bExactMatch = true) const;
@@ -198,7 +515,7 @@ public:
 	 * 
 	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
 	 * @param ActorClass Only actors matching this class we'll be returned
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeterminesOutputType = "ActorClass"))
 	TSet<AActor*> GetFlowActorsByTag(const FGameplayTag Tag, const TSubclassOf<AActor> ActorClass, const bool bExactMatch = true) const;
@@ -209,7 +526,7 @@ public:
 	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
 	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
 	 * @param ActorClass Only actors matching this class we'll be returned
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeterminesOutputType = "ActorClass"))
 	TSet<AActor*> GetFlowActorsByTags(const FGameplayTagContainer Tags, const EGameplayContainerMatchType MatchType, const TSubclassOf<AActor> ActorClass, const bool bExactMatch = true) const;
@@ -219,7 +536,7 @@ public:
 	 * 
 	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
 	 * @param ActorClass Only actors matching this class we'll be returned
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeterminesOutputType = "ActorClass"))
 	TMap<AActor*, UFlowComponent*> GetFlowActorsAndComponentsByTag(const FGameplayTag Tag, const TSubclassOf<AActor> ActorClass, const bool bExactMatch = true) const;
@@ -230,7 +547,7 @@ public:
 	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
 	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
 	 * @param ActorClass Only actors matching this class we'll be returned
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	UFUNCTION(BlueprintPure, Category = "FlowSubsystem", meta = (DeterminesOutputType = "ActorClass"))
 	TMap<AActor*, UFlowComponent*> GetFlowActorsAndComponentsByTags(const FGameplayTagContainer Tags, const EGameplayContainerMatchType MatchType, const TSubclassOf<AActor> ActorClass, const bool bExactMatch = true) const;
@@ -240,7 +557,7 @@ public:
 	 * 
 	 * @tparam T Only components matching this class we'll be returned
 	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	template <class T>
 	TSet<TWeakObjectPtr<T>> GetComponents(const FGameplayTag& Tag, const bool bExactMatch = true) const
@@ -271,7 +588,7 @@ public:
 	 * @tparam T Only components matching this class we'll be returned
 	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
 	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	template <class T>
 	TSet<TWeakObjectPtr<T>> GetComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch = true) const
@@ -301,7 +618,7 @@ public:
 	 * 
 	 * @tparam T Only components matching this class we'll be returned
 	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	template <class T>
 	TSet<TWeakObjectPtr<T>> GetActors(const FGameplayTag& Tag, const bool bExactMatch = true) const
@@ -332,7 +649,7 @@ public:
 	 * @tparam T Only actors matching this class we'll be returned
 	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
 	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	template <class T>
 	TSet<TWeakObjectPtr<T>> GetActors(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch = true) const
@@ -363,7 +680,7 @@ public:
 	 * @tparam ActorT Only actors matching this class we'll be returned
 	 * @tparam ComponentT Only components matching this class we'll be returned
 	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	template <class ActorT, class ComponentT>
 	TMap<TWeakObjectPtr<ActorT>, TWeakObjectPtr<ComponentT>> GetActorsAndComponents(const FGameplayTag& Tag, const bool bExactMatch = true) const
@@ -398,7 +715,7 @@ public:
 	 * @tparam ComponentT Only components matching this class we'll be returned
 	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
 	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
-	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching. Be careful, using latter option may be very expensive, as the search cost is proportional to the number of registered Gameplay Tags!
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
 	 */
 	template <class ActorT, class ComponentT>
 	TMap<TWeakObjectPtr<ActorT>, TWeakObjectPtr<ComponentT>> GetActorsAndComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch = true) const
@@ -426,7 +743,195 @@ public:
 		return Result;
 	}
 
+	/**
+	 * Calls Visitor for every registered Flow Component identified by given tag, doesn't allocate any memory
+	 * Visitor must not register or unregister Flow Components, nor change their Identity Tags
+	 * 
+	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	void ForEachComponent(const FGameplayTag& Tag, const bool bExactMatch, TFunctionRef<void(UFlowComponent*)> Visitor) const;
+
+	/**
+	 * Calls Visitor once for every registered Flow Component identified by Any or All provided tags, doesn't allocate any memory
+	 * Visitor must not register or unregister Flow Components, nor change their Identity Tags
+	 * 
+	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
+	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	void ForEachComponent(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch, TFunctionRef<void(UFlowComponent*)> Visitor) const;
+
+	/**
+	 * Appends all registered Flow Components identified by given tag to the provided array
+	 * Caller can pass TArray with TInlineAllocator to run the query without any heap allocation
+	 * 
+	 * @tparam T Only components matching this class we'll be added
+	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
+	 * @param OutComponents Array to append found components to, it's not emptied before the query
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	template <class T, typename AllocatorType>
+	void GetComponents(const FGameplayTag& Tag, TArray<T*, AllocatorType>& OutComponents, const bool bExactMatch = true) const
+	{
+		static_assert(TPointerIsConvertibleFromTo<T, const UActorComponent>::Value, "'T' template parameter to GetComponents must be derived from UActorComponent");
+
+		ForEachComponent(Tag, bExactMatch, [&OutComponents](UFlowComponent* Component)
+		{
+			if (T* ComponentOfClass = Cast<T>(Component))
+			{
+				OutComponents.Emplace(ComponentOfClass);
+			}
+		});
+	}
+
+	/**
+	 * Appends all registered Flow Components identified by Any or All provided tags to the provided array
+	 * Caller can pass TArray with TInlineAllocator to run the query without any heap allocation
+	 * 
+	 * @tparam T Only components matching this class we'll be added
+	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
+	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
+	 * @param OutComponents Array to append found components to, it's not emptied before the query
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	template <class T, typename AllocatorType>
+	void GetComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, TArray<T*, AllocatorType>& OutComponents, const bool bExactMatch = true) const
+	{
+		static_assert(TPointerIsConvertibleFromTo<T, const UActorComponent>::Value, "'T' template parameter to GetComponents must be derived from UActorComponent");
+
+		ForEachComponent(Tags, MatchType, bExactMatch, [&OutComponents](UFlowComponent* Component)
+		{
+			if (T* ComponentOfClass = Cast<T>(Component))
+			{
+				OutComponents.Emplace(ComponentOfClass);
+			}
+		});
+	}
+
+	/**
+	 * Appends owners of all registered Flow Components identified by given tag to the provided array
+	 * Caller can pass TArray with TInlineAllocator to run the query without any heap allocation
+	 * Actor owning multiple Flow Components is added once per every component identified by the tag
+	 * 
+	 * @tparam T Only actors matching this class we'll be added
+	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
+	 * @param OutActors Array to append found actors to, it's not emptied before the query
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	template <class T, typename AllocatorType>
+	void GetActors(const FGameplayTag& Tag, TArray<T*, AllocatorType>& OutActors, const bool bExactMatch = true) const
+	{
+		static_assert(TPointerIsConvertibleFromTo<T, const AActor>::Value, "'T' template parameter to GetActors must be derived from AActor");
+
+		ForEachComponent(Tag, bExactMatch, [&OutActors](UFlowComponent* Component)
+		{
+			if (T* ActorOfClass = Cast<T>(Component->GetOwner()))
+			{
+				OutActors.Emplace(ActorOfClass);
+			}
+		});
+	}
+
+	/**
+	 * Appends owners of all registered Flow Components identified by Any or All provided tags to the provided array
+	 * Caller can pass TArray with TInlineAllocator to run the query without any heap allocation
+	 * Actor owning multiple Flow Components is added once per every component identified by the tags
+	 * 
+	 * @tparam T Only actors matching this class we'll be added
+	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
+	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
+	 * @param OutActors Array to append found actors to, it's not emptied before the query
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	template <class T, typename AllocatorType>
+	void GetActors(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, TArray<T*, AllocatorType>& OutActors, const bool bExactMatch = true) const
+	{
+		static_assert(TPointerIsConvertibleFromTo<T, const AActor>::Value, "'T' template parameter to GetActors must be derived from AActor");
+
+		ForEachComponent(Tags, MatchType, bExactMatch, [&OutActors](UFlowComponent* Component)
+		{
+			if (T* ActorOfClass = Cast<T>(Component->GetOwner()))
+			{
+				OutActors.Emplace(ActorOfClass);
+			}
+		});
+	}
+
+	/**
+	 * Appends all registered actors with Flow Component identified by given tag to the provided array, as pairs of actor and its component
+	 * Caller can pass TArray with TInlineAllocator to run the query without any heap allocation
+	 * 
+	 * @tparam ActorT Only actors matching this class we'll be added
+	 * @tparam ComponentT Only components matching this class we'll be added
+	 * @param Tag Tag to check if it matches Identity Tags of registered Flow Components
+	 * @param OutPairs Array to append found pairs to, it's not emptied before the query
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	template <class ActorT, class ComponentT, typename AllocatorType>
+	void GetActorsAndComponents(const FGameplayTag& Tag, TArray<TPair<ActorT*, ComponentT*>, AllocatorType>& OutPairs, const bool bExactMatch = true) const
+	{
+		static_assert(TPointerIsConvertibleFromTo<ActorT, const AActor>::Value, "'ActorT' template parameter to GetActorsAndComponents must be derived from AActor");
+		static_assert(TPointerIsConvertibleFromTo<ComponentT, const UActorComponent>::Value, "'ComponentT' template parameter to GetActorsAndComponents must be derived from UActorComponent");
+
+		ForEachComponent(Tag, bExactMatch, [&OutPairs](UFlowComponent* Component)
+		{
+			ComponentT* ComponentOfClass = Cast<ComponentT>(Component);
+			ActorT* ActorOfClass = Cast<ActorT>(Component->GetOwner());
+			if (ComponentOfClass && ActorOfClass)
+			{
+				OutPairs.Emplace(ActorOfClass, ComponentOfClass);
+			}
+		});
+	}
+
+	/**
+	 * Appends all registered actors with Flow Component identified by Any or All provided tags to the provided array, as pairs of actor and its component
+	 * Caller can pass TArray with TInlineAllocator to run the query without any heap allocation
+	 * 
+	 * @tparam ActorT Only actors matching this class we'll be added
+	 * @tparam ComponentT Only components matching this class we'll be added
+	 * @param Tags Container to check if it matches Identity Tags of registered Flow Components
+	 * @param MatchType If Any, returned component needs to have only one of given tags. If All, component needs to have all given Identity Tags
+	 * @param OutPairs Array to append found pairs to, it's not emptied before the query
+	 * @param bExactMatch If true, the tag has to be exactly present, if false then TagContainer will include it's parent tags while matching.
+	 */
+	template <class ActorT, class ComponentT, typename AllocatorType>
+	void GetActorsAndComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, TArray<TPair<ActorT*, ComponentT*>, AllocatorType>& OutPairs, const bool bExactMatch = true) const
+	{
+		static_assert(TPointerIsConvertibleFromTo<ActorT, const AActor>::Value, "'ActorT' template parameter to GetActorsAndComponents must be derived from AActor");
+		static_assert(TPointerIsConvertibleFromTo<ComponentT, const UActorComponent>::Value, "'ComponentT' template parameter to GetActorsAndComponents must be derived from UActorComponent");
+
+		ForEachComponent(Tags, MatchType, bExactMatch, [&OutPairs](UFlowComponent* Component)
+		{
+			ComponentT* ComponentOfClass = Cast<ComponentT>(Component);
+			ActorT* ActorOfClass = Cast<ActorT>(Component->GetOwner());
+			if (ComponentOfClass && ActorOfClass)
+			{
+				OutPairs.Emplace(ActorOfClass, ComponentOfClass);
+			}
+		});
+	}
+
+//////////////////////////////////////////////////////////////////////////
+// Testing
+
+public:
+	/* Tests drive the subsystem directly, without actors registering their components or the world ticking timers */
+	void RegisterComponent_ForTesting(UFlowComponent* Component) { RegisterComponent(Component); }
+	void UnregisterComponent_ForTesting(UFlowComponent* Component) { UnregisterComponent(Component); }
+	void TickTimerWheel_ForTesting() { TickTimerWheel(); }
+
+	/* Pooled instances keep their node instances, so tests changing instancing settings start with the empty pool */
+	void RemoveInstancePool_ForTesting(UFlowAsset* TemplateAsset) { InstancePools.Remove(TemplateAsset); }
+
+	/* Tests load records without calling OnGameLoaded(), as projects apply loaded data to their own systems there */
+	void SetLoadedSaveGame_ForTesting(UFlowSaveGame* SaveGame) { LoadedSaveGame = SaveGame; }
+
 private:
 	void FindComponents(const FGameplayTag& Tag, const bool bExactMatch, TArray<TWeakObjectPtr<UFlowComponent>>& OutComponents) const;
 	void FindComponents(const FGameplayTagContainer& Tags, const EGameplayContainerMatchType MatchType, const bool bExactMatch, TSet<TWeakObjectPtr<UFlowComponent>>& OutComponents) const;
+
+	bool IsComponentIdentifiedBy(const UFlowComponent* Component, const FGameplayTag& Tag, const bool bExactMatch) const;
+	int32 GetTagIndexBucketNum(const FGameplayTag& Tag) const;
 };
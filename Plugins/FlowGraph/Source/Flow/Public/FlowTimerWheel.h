@@ -0,0 +1,141 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UFlowAsset;
+
+DECLARE_DELEGATE(FFlowTimerDelegate);
+
+/* Identifies timer scheduled in the Flow Subsystem, see UFlowSubsystem::SetFlowTimer */
+struct FLOW_API FFlowTimerHandle
+{
+	friend class FFlowTimerWheel;
+
+	FFlowTimerHandle()
+		: Index(INDEX_NONE)
+		, Serial(0)
+	{
+	}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	void Invalidate()
+	{
+		Index = INDEX_NONE;
+		Serial = 0;
+	}
+
+	bool operator==(const FFlowTimerHandle& Other) const { return Index == Other.Index && Serial == Other.Serial; }
+	bool operator!=(const FFlowTimerHandle& Other) const { return !(*this == Other); }
+
+private:
+	int32 Index;
+	uint32 Serial;
+};
+
+/**
+ * Hierarchical timer wheel, counting time in fixed ticks
+ * - setting and clearing a timer costs the same regardless of the number of timers
+ * - distant timers wait in coarse levels and cascade into finer levels as their time approaches
+ * - paused timers are taken out of the wheel, keeping their remaining ticks
+ */
+class FLOW_API FFlowTimerWheel
+{
+public:
+	FFlowTimerWheel();
+
+	/* Delegate is called after DelayTicks, and then every IntervalTicks if it's greater than 0
+	 * Timers of the same RootFlow can be paused together */
+	FFlowTimerHandle SetTimer(FFlowTimerDelegate&& Delegate, const uint32 DelayTicks, const uint32 IntervalTicks, UFlowAsset* RootFlow, const bool bPaused);
+	void ClearTimer(FFlowTimerHandle& Handle);
+
+	bool IsTimerActive(const FFlowTimerHandle& Handle) const;
+
+	/* Returns 0 if timer isn't active */
+	uint32 GetTicksRemaining(const FFlowTimerHandle& Handle) const;
+
+	void SetPaused(const UFlowAsset* RootFlow, const bool bPaused);
+
+	/* Advances time by a single tick, calling delegates of all timers due in this tick */
+	void Tick();
+
+	void Reset();
+
+	/* Number of active timers, including paused ones */
+	int32 Num() const { return ActiveTimersNum; }
+
+	/* Number of timers waiting in the wheel, the wheel needs ticking only if there's any */
+	int32 NumScheduled() const { return ActiveTimersNum - PausedTimersNum; }
+
+private:
+	struct FTimer
+	{
+		FFlowTimerDelegate Delegate;
+		TWeakObjectPtr<UFlowAsset> RootFlow;
+
+		uint64 DueTick;
+		uint32 IntervalTicks;
+		uint32 PausedTicksRemaining;
+
+		// Changes after clearing the timer, invalidating handles
+		uint32 Serial;
+
+		// Changes whenever timer leaves the wheel, invalidating its slot entry
+		uint32 Generation;
+
+		bool bActive;
+		bool bPaused;
+
+		FTimer()
+			: DueTick(0)
+			, IntervalTicks(0)
+			, PausedTicksRemaining(0)
+			, Serial(0)
+			, Generation(0)
+			, bActive(false)
+			, bPaused(false)
+		{
+		}
+	};
+
+	// Cleared or paused timers aren't removed from slots, their entries are skipped after the generation check
+	struct FSlotEntry
+	{
+		int32 Index;
+		uint32 Generation;
+	};
+
+	static constexpr int32 RootBits = 8;
+	static constexpr int32 RootSize = 1 << RootBits;
+	static constexpr int32 LevelBits = 6;
+	static constexpr int32 LevelSize = 1 << LevelBits;
+	static constexpr int32 NumLevels = 3;
+
+	// Slot per tick for timers due in the next RootSize ticks
+	TArray<FSlotEntry> RootSlots[RootSize];
+
+	// Every slot of the next level covers all slots of the previous level
+	TArray<FSlotEntry> LevelSlots[NumLevels][LevelSize];
+
+	// Timers beyond the range of the last level
+	TArray<FSlotEntry> OverflowSlot;
+
+	// Root slot taken out of the wheel while its timers are called
+	TArray<FSlotEntry> DueEntries;
+
+	TArray<FTimer> Timers;
+	TArray<int32> FreeTimers;
+
+	uint64 CurrentTick;
+	int32 ActiveTimersNum;
+	int32 PausedTimersNum;
+
+	const FTimer* FindTimer(const FFlowTimerHandle& Handle) const;
+
+	void Insert(const int32 Index);
+	void Cascade(TArray<FSlotEntry>& Slot);
+	void Release(const int32 Index);
+};
@@ -31,6 +31,12 @@ public:
 	void K2_DeinitializeInstance();
 	virtual void DeinitializeInstance() { Execute_K2_DeinitializeInstance(Cast<UObject>(this)); }
 
+	// Called after deinitializing the instance, if Flow Asset instance is kept for reuse by the instance pool
+	// Restore here any runtime state not stored in properties, so the next run starts like a freshly created instance
+	UFUNCTION(BlueprintImplementableEvent, Category = "FlowNode", DisplayName = "Reset Instance")
+	void K2_ResetInstance();
+	virtual void ResetInstance() { Execute_K2_ResetInstance(Cast<UObject>(this)); }
+
 	// If preloading is enabled, will be called to preload content
 	UFUNCTION(BlueprintImplementableEvent, Category = "FlowNode", DisplayName = "Preload Content")
 	void K2_PreloadContent();
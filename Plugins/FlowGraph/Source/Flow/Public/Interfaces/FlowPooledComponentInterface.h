@@ -0,0 +1,35 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#pragma once
+
+#include "UObject/Interface.h"
+
+#include "FlowPooledComponentInterface.generated.h"
+
+class AActor;
+
+// Implemented by components injected by Flow, which can be reused by the component pool
+// (components not implementing it are destroyed after removal, as usual)
+UINTERFACE(MinimalAPI, Blueprintable, DisplayName = "Flow Pooled Component Interface")
+class UFlowPooledComponentInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class FLOW_API IFlowPooledComponentInterface
+{
+	GENERATED_BODY()
+
+public:
+
+	// Called after removing the component from the actor, before keeping it in the pool
+	// Restore here any runtime state, so the next use starts like a freshly created component
+	UFUNCTION(BlueprintImplementableEvent, Category = "FlowComponentPool", DisplayName = "Reset For Pool")
+	void K2_ResetForPool();
+	virtual void ResetForPool() { Execute_K2_ResetForPool(Cast<UObject>(this)); }
+
+	// Called after taking the component from the pool, before registering it on the new owner
+	UFUNCTION(BlueprintImplementableEvent, Category = "FlowComponentPool", DisplayName = "Reuse From Pool")
+	void K2_ReuseFromPool(AActor* NewOwner);
+	virtual void ReuseFromPool(AActor* NewOwner) { Execute_K2_ReuseFromPool(Cast<UObject>(this), NewOwner); }
+};
@@ -33,6 +33,7 @@ public:
 		ALevelSequenceActor*& OutActor);
 
 	void SetFlowEventReceiver(UFlowNode* FlowNode) { FlowEventReceiver = FlowNode; }
+	UFlowNode* GetFlowEventReceiver() const { return FlowEventReceiver; }
 
 	// IMovieScenePlayer
 	virtual TArray<UObject*> GetEventContexts() const override;
@@ -45,11 +45,13 @@ struct FMovieSceneFlowTriggerTemplate : public FMovieSceneFlowTemplateBase
 	FMovieSceneFlowTriggerTemplate() {}
 	FMovieSceneFlowTriggerTemplate(const UMovieSceneFlowTriggerSection& Section, const UMovieSceneFlowTrack& Track);
 
+	// Sorted, so events in the swept range are found by binary search
 	UPROPERTY()
 	TArray<FFrameNumber> EventTimes;
 
+	// Events without a name are skipped while compiling the template
 	UPROPERTY()
-	TArray<FString> EventNames;
+	TArray<FName> EventNames;
 
 private:
 	virtual UScriptStruct& GetScriptStructImpl() const override { return *StaticStruct(); }
@@ -65,7 +67,7 @@ struct FMovieSceneFlowRepeaterTemplate : public FMovieSceneFlowTemplateBase
 	FMovieSceneFlowRepeaterTemplate(const UMovieSceneFlowRepeaterSection& Section, const UMovieSceneFlowTrack& Track);
 
 	UPROPERTY()
-	FString EventName;
+	FName EventName;
 
 private:
 	virtual UScriptStruct& GetScriptStructImpl() const override { return *StaticStruct(); }
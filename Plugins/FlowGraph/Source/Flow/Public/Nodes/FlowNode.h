@@ -12,6 +12,8 @@
 
 #include "FlowNode.generated.h"
 
+struct FFlowCompiledGraph;
+
 /**
  * A Flow Node is UObject-based node designed to handle entire gameplay feature within single node.
  */
@@ -48,6 +50,10 @@ public:
 	virtual bool IsSupportedInputPinName(const FName& PinName) const override;
 	// --
 
+	// IFlowCoreExecutableInterface
+	virtual void ResetInstance() override;
+	// --
+
 public:
 #if WITH_EDITOR
 	// UObject	
@@ -154,6 +160,10 @@ protected:
 
 public:
 	void SetConnections(const TMap<FName, FConnectedPin>& InConnections) { Connections = InConnections; }
+
+	// Tests build transient graphs in code, otherwise pins and connections are set by the graph editor
+	void AddConnection_ForTesting(const FName& OutputPinName, const FConnectedPin& Connection) { Connections.Add(OutputPinName, Connection); }
+	void SetOutputPins_ForTesting(const TArray<FFlowPin>& Pins) { OutputPins = Pins; }
 	FConnectedPin GetConnection(const FName OutputName) const { return Connections.FindRef(OutputName); }
 
 	UFUNCTION(BlueprintPure, Category= "FlowNode")
@@ -164,11 +174,32 @@ public:
 	UFUNCTION(BlueprintPure, Category= "FlowNode")
 	bool IsInputConnected(const FName& PinName) const;
 
+	// Returns output pins of other nodes (node guid and pin name) connected to the given input pin
+	TConstArrayView<FConnectedPin> GetInputConnections(const FName& PinName) const;
+
 	UFUNCTION(BlueprintPure, Category= "FlowNode")
 	bool IsOutputConnected(const FName& PinName) const;
 
 	static void RecursiveFindNodesByClass(UFlowNode* Node, const TSubclassOf<UFlowNode> Class, uint8 Depth, TArray<UFlowNode*>& OutNodes);
 
+//////////////////////////////////////////////////////////////////////////
+// Compiled graph, allowing to route signals without searching pins by name
+
+public:
+	static constexpr uint16 InvalidPinIndex = MAX_uint16;
+
+private:
+	// Index of this node in the compiled graph of the Flow Asset instance, INDEX_NONE on templates
+	int32 CompiledIndex;
+
+	const FFlowCompiledGraph* GetCompiledGraph() const;
+
+public:
+	int32 GetCompiledIndex() const { return CompiledIndex; }
+
+	uint16 FindInputPinIndex(const FName& PinName) const;
+	uint16 FindOutputPinIndex(const FName& PinName) const;
+
 //////////////////////////////////////////////////////////////////////////
 // Debugger
 
@@ -188,30 +219,48 @@ protected:
 	UPROPERTY(SaveGame)
 	EFlowNodeState ActivationState;
 
+private:
+	// Index in the UFlowAsset::ActiveNodes, INDEX_NONE if node isn't active
+	int32 ActiveNodeIndex;
+
 public:
 	EFlowNodeState GetActivationState() const { return ActivationState; }
 
-#if !UE_BUILD_SHIPPING
+#if FLOW_WITH_PIN_RECORDS
 
 private:
-	TMap<FName, TArray<FPinRecord>> InputRecords;
-	TMap<FName, TArray<FPinRecord>> OutputRecords;
+	// Activation history per pin index, capacity is defined by UFlowSettings::MaxPinRecords
+	TArray<FPinRecordHistory> InputRecords;
+	TArray<FPinRecordHistory> OutputRecords;
+
+	static void AddPinRecord(TArray<FPinRecordHistory>& Records, const int32 PinsNum, const uint16 PinIndex, const EFlowPinActivationType ActivationType);
 #endif
 
 public:
 	void TriggerPreload();
 	void TriggerFlush();
 
+	// Template nodes are shared by all instances of the asset, GetNodeInstance() of the asset instance provides the node instance
+	bool IsTemplateNode() const;
+
+private:
+	// Runtime state of template nodes is never mutated, returns false after reporting such attempt
+	bool EnsureNodeInstance(const TCHAR* Operation) const;
+
 protected:
 
 	// Trigger execution of input pin
 	void TriggerInput(const FName& PinName, const EFlowPinActivationType ActivationType = EFlowPinActivationType::Default);
+	void TriggerInputByIndex(const uint16 InputPinIndex, const EFlowPinActivationType ActivationType = EFlowPinActivationType::Default);
 
 protected:
 	void Deactivate();
 
 	virtual void TriggerFirstOutput(const bool bFinish) override;
 	virtual void TriggerOutput(FName PinName, const bool bFinish = false, const EFlowPinActivationType ActivationType = EFlowPinActivationType::Default) override;
+
+	// Skips the pin name lookup, but bypasses TriggerOutput() overrides, so generic paths of the base node don't use it
+	void TriggerOutputByIndex(const uint16 OutputPinIndex, const bool bFinish = false, const EFlowPinActivationType ActivationType = EFlowPinActivationType::Default);
 public:
 	virtual void Finish() override;
 
@@ -228,6 +277,29 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FlowNode")
 	void LoadInstance(const FFlowNodeSaveData& NodeRecord);
 
+	// Incremental save serializes only nodes marked dirty since the previous save
+	// Node is marked dirty on every input and on finish, call it after changing SaveGame properties at other moments
+	UFUNCTION(BlueprintCallable, Category = "FlowNode")
+	void MarkSaveDirty();
+
+	// Override it if OnSave() captures state changing without node's involvement, i.e. the remaining time of a timer
+	virtual bool IsSaveDirty() const { return bSaveDirty; }
+
+	// Calls OnSave() on the clean node opted in by bAlwaysCallOnSave, marks it dirty if its SaveGame state changed since the previous save
+	void UpdateSaveDirty();
+
+protected:
+	// Enable it if OnSave() captures state without marking the node dirty, i.e. in Blueprint
+	// Incremental save calls OnSave() then also on the clean node and reuses its record only if the saved data didn't change
+	UPROPERTY(EditDefaultsOnly, AdvancedDisplay, Category = "FlowNode")
+	bool bAlwaysCallOnSave;
+
+private:
+	bool bSaveDirty;
+
+	// CRC of SaveGame state written by the previous save, used only with bAlwaysCallOnSave
+	uint32 SaveDataHash;
+
 protected:
 	UFUNCTION(BlueprintNativeEvent, Category = "FlowNode")
 	void OnSave();
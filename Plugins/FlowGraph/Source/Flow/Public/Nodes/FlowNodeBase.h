@@ -52,6 +52,7 @@ public:
 	// IFlowCoreExecutableInterface
 	virtual void InitializeInstance() override;
 	virtual void DeinitializeInstance() override;
+	virtual void ResetInstance() override;
 
 	virtual void PreloadContent() override;
 	virtual void FlushContent() override;
@@ -131,6 +132,10 @@ protected:
 	static IFlowOwnerInterface* TryGetFlowOwnerInterfaceFromRootFlowOwner(UObject& RootFlowOwner, const UClass& ExpectedOwnerClass);
 	static IFlowOwnerInterface* TryGetFlowOwnerInterfaceActor(UObject& RootFlowOwner, const UClass& ExpectedOwnerClass);
 
+private:
+	// Node or AddOn this instance has been created from, used to restore property values by ResetInstance()
+	TWeakObjectPtr<const UFlowNodeBase> InstanceTemplate;
+
 //////////////////////////////////////////////////////////////////////////
 // AddOn support
 
@@ -2,9 +2,16 @@
 
 #pragma once
 
+#include "Misc/DateTime.h"
 #include "UObject/ObjectMacros.h"
 #include "FlowPin.generated.h"
 
+// Pin activation history is only kept for debugging purposes
+// Define FLOW_WITH_PIN_RECORDS=0 in the Target.cs to strip it also from non-shipping builds, i.e. for soak tests or dedicated servers
+#ifndef FLOW_WITH_PIN_RECORDS
+#define FLOW_WITH_PIN_RECORDS !UE_BUILD_SHIPPING
+#endif
+
 USTRUCT(BlueprintType)
 struct FLOW_API FFlowPin
 {
@@ -192,11 +199,11 @@ enum class EFlowPinActivationType : uint8
 };
 
 // Every time pin is activated, we record it and display this data while user hovers mouse over pin
-#if !UE_BUILD_SHIPPING
+#if !UE_BUILD_SHIPPING || FLOW_WITH_PIN_RECORDS
 struct FLOW_API FPinRecord
 {
 	double Time;
-	FString HumanReadableTime;
+	FDateTime SystemTime;
 	EFlowPinActivationType ActivationType;
 
 	static FString NoActivations;
@@ -207,11 +214,46 @@ struct FLOW_API FPinRecord
 	FPinRecord();
 	FPinRecord(const double InTime, const EFlowPinActivationType InActivationType);
 
+	// Formatted only on demand, so recording activation doesn't allocate memory
+	FString GetHumanReadableTime() const;
+
 private:
 	FORCEINLINE static FString DoubleDigit(const int32 Number);
 };
 #endif
 
+#if FLOW_WITH_PIN_RECORDS
+// Fixed-capacity history of pin activations, the oldest record is overwritten once capacity is reached
+// Memory is allocated only until history is filled for the first time
+struct FLOW_API FPinRecordHistory
+{
+private:
+	TArray<FPinRecord> Records;
+
+	// Index of the oldest record, meaningful only after history has been filled
+	int32 Head;
+	int32 Capacity;
+
+public:
+	FPinRecordHistory()
+		: Head(0)
+		, Capacity(0)
+	{
+	}
+
+	void Add(const FPinRecord& Record, const int32 InCapacity);
+
+	// Removes all records, but keeps allocated memory
+	void Reset();
+
+	int32 Num() const { return Records.Num(); }
+	const FPinRecord& Last() const { return Records[(Head + Records.Num() - 1) % Records.Num()]; }
+
+	// Returns records from the oldest to the most recent one
+	TArray<FPinRecord> GetRecords() const;
+};
+#endif
+
 // It can represent any trait added on the specific node instance, i.e. breakpoint
 USTRUCT()
 struct FLOW_API FFlowPinTrait
@@ -2,12 +2,13 @@
 
 #pragma once
 
-#include "Engine/EngineTypes.h"
+#include "FlowTimerWheel.h"
 #include "Nodes/FlowNode.h"
 #include "FlowNode_Timer.generated.h"
 
 /**
  * Triggers outputs after time elapsed
+ * Uses Flow Timers, so it's paused with other timers of the Root Flow
  */
 UCLASS(NotBlueprintable, meta = (DisplayName = "Timer", Keywords = "delay, step, tick"))
 class FLOW_API UFlowNode_Timer : public UFlowNode
@@ -24,8 +25,8 @@ protected:
 	float StepTime;
 
 private:
-	FTimerHandle CompletionTimerHandle;
-	FTimerHandle StepTimerHandle;
+	FFlowTimerHandle CompletionTimerHandle;
+	FFlowTimerHandle StepTimerHandle;
 
 	UPROPERTY(SaveGame)
 	float SumOfSteps;
@@ -43,6 +44,9 @@ protected:
 	virtual void Restart();
 	
 private:
+	void SetStepTimer(const float FirstDelay);
+	void SetCompletionTimer(const float Delay);
+
 	UFUNCTION()
 	void OnStep();
 
@@ -54,7 +58,12 @@ protected:
 
 	virtual void OnSave_Implementation() override;
 	virtual void OnLoad_Implementation() override;
-	
+
+public:
+	// remaining time is captured only in OnSave(), so the node is dirty only if timers advanced since the previous save
+	virtual bool IsSaveDirty() const override;
+
+protected:
 #if WITH_EDITOR
 	virtual FString GetNodeDescription() const override;
 	virtual FString GetStatusString() const override;
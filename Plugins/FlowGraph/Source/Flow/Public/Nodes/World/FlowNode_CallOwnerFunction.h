@@ -56,6 +56,10 @@ public:
 	static UClass* GetParamsClassForFunction(const UFunction& Function);
 
 protected:
+	// IFlowCoreExecutableInterface
+	virtual void InitializeInstance() override;
+	// --
+
 	// UFlowNode
 	virtual void ExecuteInput(const FName& PinName) override;
 	// --
@@ -77,4 +81,7 @@ protected:
 	// Parameter object to pass to the function when called
 	UPROPERTY(EditAnywhere, Category = "Call Owner", Instanced)
 	UFlowOwnerFunctionParams* Params;
+
+	// Output names the function can return, gathered once per instance
+	TArray<FName> ValidOutputNames;
 };
@@ -19,6 +19,7 @@ class FLOW_API UFlowNode_ComponentObserver : public UFlowNode
 	GENERATED_UCLASS_BODY()
 	
 	friend class FFlowNode_ComponentObserverDetails;
+	friend class UFlowSubsystem;
 
 protected:
 	UPROPERTY(EditAnywhere, Category = "ObservedComponent")
@@ -116,6 +116,11 @@ protected:
 	UPROPERTY(EditAnywhere, Category = Configuration, DisplayName = "Allow injecting component", meta = (EditConditionHides, EditCondition = "ComponentSource == EExecuteComponentSource::InjectFromClass && bReuseExistingComponent"))
 	bool bAllowInjectComponent = true;
 
+	// Register the injected component in one of the next frames, within UFlowSettings::MaxComponentRegistrationsPerFrame
+	//  (the component is registered immediately, if the node activates before that)
+	UPROPERTY(EditAnywhere, Category = Configuration, DisplayName = "Defer component registration", meta = (EditConditionHides, EditCondition = "ComponentSource == EExecuteComponentSource::InjectFromTemplate || ComponentSource == EExecuteComponentSource::InjectFromClass"))
+	bool bDeferComponentRegistration = false;
+
 	// Inject component(s) onto the owning Actor
 	UPROPERTY()
 	EExecuteComponentSource ComponentSource = EExecuteComponentSource::Undetermined;
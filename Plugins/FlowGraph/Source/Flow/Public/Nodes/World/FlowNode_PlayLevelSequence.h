@@ -105,8 +105,12 @@ protected:
 	virtual void OnSave_Implementation() override;
 	virtual void OnLoad_Implementation() override;
 
+public:
+	// playback position is captured only in OnSave(), so the node is dirty only if the sequence played since the previous save
+	virtual bool IsSaveDirty() const override;
+
 private:
-	void TriggerEvent(const FString& EventName);
+	void TriggerEvent(const FName& EventName);
 
 public:
 	void OnTimeDilationUpdate(const float NewTimeDilation);
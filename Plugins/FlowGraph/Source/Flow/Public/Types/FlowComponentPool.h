@@ -0,0 +1,127 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#pragma once
+
+#include "Containers/RingBuffer.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/Object.h"
+
+#include "FlowComponentPool.generated.h"
+
+class AActor;
+class UActorComponent;
+class UWorld;
+
+// Released components of the single template (or class) kept for reuse
+//  (referenced by UFlowComponentPool::AddReferencedObjects)
+struct FLOW_API FFlowPooledComponents
+{
+	TArray<TObjectPtr<UActorComponent>> Components;
+
+	int32 Hits = 0;
+	int32 Misses = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FLOW_API FFlowComponentPoolStats
+{
+	GENERATED_BODY()
+
+public:
+
+	// Number of components taken from the pool
+	UPROPERTY(BlueprintReadOnly, Category = "FlowComponentPool")
+	int32 Hits = 0;
+
+	// Number of components created, because the pool was empty
+	UPROPERTY(BlueprintReadOnly, Category = "FlowComponentPool")
+	int32 Misses = 0;
+
+	// Number of released components waiting for reuse
+	UPROPERTY(BlueprintReadOnly, Category = "FlowComponentPool")
+	int32 PooledComponents = 0;
+
+	// Number of injected components waiting for the deferred registration, in the entire pool
+	UPROPERTY(BlueprintReadOnly, Category = "FlowComponentPool")
+	int32 PendingRegistrations = 0;
+};
+
+// Component waiting for registration on the actor, see UFlowComponentPool::QueueRegistration
+struct FFlowPendingComponentRegistration
+{
+	TWeakObjectPtr<AActor> Actor;
+	TWeakObjectPtr<UActorComponent> Component;
+
+	FFlowPendingComponentRegistration(AActor* InActor, UActorComponent* InComponent)
+		: Actor(InActor)
+		, Component(InComponent)
+	{
+	}
+};
+
+// Reuses components injected by Flow, so actors streaming in and out don't pay for constructing components every time
+// - only components implementing IFlowPooledComponentInterface are pooled, see UFlowSettings::MaxPooledComponents
+// - registration of injected components can be spread over frames, see UFlowSettings::MaxComponentRegistrationsPerFrame
+UCLASS()
+class FLOW_API UFlowComponentPool : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Take a component created from this template from the pool, or create a new one
+	//  (PoolKey identifies the template, as instanced templates are copied to every Flow Node instance)
+	UActorComponent* AcquireComponent(AActor& Actor, UActorComponent& ComponentTemplate, UObject& PoolKey);
+
+	// Take a component of this class from the pool, or create a new one
+	UActorComponent* AcquireComponent(AActor& Actor, TSubclassOf<UActorComponent> ComponentClass, const FName& InstanceBaseName);
+
+	// Remove the injected component from the actor and keep it for reuse
+	//  (destroys it if it can't be pooled or the pool is full)
+	void ReleaseComponent(AActor& Actor, UActorComponent& ComponentInstance);
+
+	// Register the injected component in one of the next frames, within the registration budget
+	void QueueRegistration(AActor& Actor, UActorComponent& ComponentInstance);
+
+	// Register all the queued components immediately
+	void FlushPendingRegistrations();
+
+	// Statistics of the pool for the given component template or class
+	FFlowComponentPoolStats GetStats(const UObject* ComponentTemplateOrClass) const;
+
+	// Drop all pooled components and pending registrations
+	void Empty();
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+protected:
+
+	UActorComponent* TakeFromPool(AActor& Actor, UObject& PoolKey, const FName& InstanceBaseName);
+	UActorComponent* TrackCreatedComponent(UActorComponent* ComponentInstance, UObject& PoolKey);
+
+	static bool CanBePooled(const UActorComponent& ComponentInstance);
+
+	// Drop pools of templates or classes which don't exist anymore, their components aren't referenced since the key became invalid
+	void RemoveStalePools();
+
+	void ProcessPendingRegistrations();
+	void ScheduleRegistrations(UWorld* World);
+
+	// Returns number of registered components, MaxRegistrations equal to 0 means no limit
+	int32 RegisterPendingComponents(const int32 MaxRegistrations);
+
+protected:
+
+	// Released components by the template or class they were created from
+	//  (keys don't keep templates alive, components of pools with destroyed keys aren't referenced anymore)
+	TMap<TWeakObjectPtr<UObject>, FFlowPooledComponents> Pools;
+
+	// The template or class of components acquired through the pool, used as the pool key on release
+	TMap<TWeakObjectPtr<UActorComponent>, TWeakObjectPtr<UObject>> AcquiredComponents;
+
+	// Released or already registered components are skipped, so entries don't need to be removed on release
+	TRingBuffer<FFlowPendingComponentRegistration> PendingRegistrations;
+
+	TWeakObjectPtr<UWorld> RegistrationWorld;
+	bool bRegistrationScheduled = false;
+};
@@ -7,6 +7,7 @@
 #include "FlowInjectComponentsManager.generated.h"
 
 class UActorComponent;
+class UFlowComponentPool;
 class UFlowNodeBase;
 
 // Container for injected component instances
@@ -29,7 +30,8 @@ class UFlowInjectComponentsManager : public UObject
 
 public:
 
-	FLOW_API void InitializeRuntime();
+	// Components removed by the manager are released to the ComponentPool, if provided
+	FLOW_API void InitializeRuntime(UFlowComponentPool* InComponentPool = nullptr);
 	FLOW_API void ShutdownRuntime();
 	
 	FLOW_API FORCEINLINE void InjectComponentOnActor(AActor& Actor, UActorComponent& ComponentInstance) { AddAndRegisterComponent(Actor, ComponentInstance); }
@@ -61,6 +63,15 @@ public:
 	UPROPERTY()
 	bool bRemoveInjectedComponentsWhenDeinitializing = true;
 
+	// Register the Injected Components in the next frames, within UFlowSettings::MaxComponentRegistrationsPerFrame
+	//  (requires the ComponentPool, components are registered immediately without it, set by UFlowNode_ExecuteComponent)
+	UPROPERTY()
+	bool bDeferComponentRegistration = false;
+
+	// Pool receiving the removed components, optional
+	UPROPERTY(Transient)
+	TObjectPtr<UFlowComponentPool> ComponentPool = nullptr;
+
 	// Map of spawned components (if we are cleaning up)
 	UPROPERTY(Transient)
 	TMap<AActor*, FFlowComponentInstances> ActorToComponentsMap;
@@ -25,6 +25,7 @@ struct FFlowOwnerFunctionRef
 public:
 
 	// Resolves the function and returns the UFunction
+	//  (resolved functions are cached per class, so the class is searched only once per FunctionName)
 	UFunction* TryResolveFunction(const UClass& InClass);
 
 	// Returns a the resolved function
@@ -34,6 +35,14 @@ public:
 	// Call the function and return the Output Pin Name result
 	FName CallFunction(IFlowOwnerInterface& InFlowOwnerInterface, UFlowOwnerFunctionParams& InParams) const;
 
+	// Call the function and return the Output Pin Name result, if it's one of the ValidOutputNames
+	//  (avoids gathering the output names from the Params on every call)
+	FName CallFunction(IFlowOwnerInterface& InFlowOwnerInterface, UFlowOwnerFunctionParams& InParams, const TArray<FName>& ValidOutputNames) const;
+
+	// Forgets functions resolved for all classes
+	//  (called after reinstancing objects, as compiling a Blueprint replaces its functions)
+	static void ResetResolvedFunctions();
+
 	// Accessors
 	FName GetFunctionName() const { return FunctionName; }
 	bool IsConfigured() const { return !FunctionName.IsNone(); }
@@ -50,6 +59,12 @@ protected:
 	UPROPERTY(Transient)
 	TObjectPtr<UFunction> Function = nullptr;
 
+	// The class the Function was resolved for
+	TWeakObjectPtr<const UClass> ResolvedClass = nullptr;
+
+	// Native functions are called directly through their thunk, skipping the ProcessEvent overhead
+	bool bNativeFunction = false;
+
 #if WITH_EDITORONLY_DATA
 	UPROPERTY(VisibleAnywhere, Category = "FlowOwnerFunction", meta = (DisplayName = "Function Parameters Class"))
 	TSubclassOf<UFlowOwnerFunctionParams> ParamsClass;
@@ -0,0 +1,130 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "FlowReplicatedEventQueue.generated.h"
+
+class UFlowComponent;
+
+UENUM()
+enum class EFlowReplicatedEventType : uint8
+{
+	AddedIdentityTags,
+	RemovedIdentityTags,
+	NotifyGraph,
+	NotifyFromGraph,
+	NotifyActor
+};
+
+// Identity tags change or notify sent by the Flow Component, replicated in the order of sending
+USTRUCT()
+struct FLOW_API FFlowReplicatedEvent : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint32 Sequence;
+
+	UPROPERTY()
+	EFlowReplicatedEventType Type;
+
+	UPROPERTY()
+	FGameplayTagContainer Tags;
+
+	// Used only by NotifyActor event
+	UPROPERTY()
+	FGameplayTag ActorTag;
+
+	// Server-only, event is dropped after the retention time
+	double ServerTime;
+
+	// Server-only, events can be coalesced only within the frame they were enqueued
+	uint64 FrameNumber;
+
+	FFlowReplicatedEvent()
+		: Sequence(0)
+		, Type(EFlowReplicatedEventType::NotifyGraph)
+		, ServerTime(0.0)
+		, FrameNumber(0)
+	{
+	}
+};
+
+// Identity tags added and removed at runtime, relative to tags of the component's archetype
+// Replicated as the state with the initial replication, as identity tags events might expire before clients join
+USTRUCT()
+struct FLOW_API FFlowIdentityTagsDelta
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FGameplayTagContainer AddedTags;
+
+	UPROPERTY()
+	FGameplayTagContainer RemovedTags;
+
+	// The latest identity tags event included in this delta, clients skip events up to this one
+	UPROPERTY()
+	uint32 Sequence = 0;
+};
+
+/**
+ * Sequenced and bounded queue of identity tags changes and notifies sent by the Flow Component
+ * - clients receive every event of the burst, not only the latest delta
+ * - fast array replication sends to every connection only events it hasn't acknowledged yet
+ * - events of the same type enqueued in the same frame are coalesced, unless these would repeat a tag
+ * - events are dropped after the retention time or when the queue exceeds its capacity, see UFlowSettings
+ * - identity tags are replicated also as FFlowIdentityTagsDelta, so clients joining later receive them
+ */
+USTRUCT()
+struct FLOW_API FFlowReplicatedEventQueue : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	friend class UFlowComponent;
+
+	// Server-only
+	void Enqueue(const EFlowReplicatedEventType Type, const FGameplayTagContainer& Tags, const FGameplayTag& ActorTag, const double ServerTime);
+
+	// Server-only, returns true if any event is still waiting for expiration
+	bool RemoveExpiredEvents(const double ServerTime, const double RetentionTime);
+
+	int32 Num() const { return Events.Num(); }
+
+	// Server-only, sequence of the latest enqueued event
+	uint32 GetLastSequence() const { return NextSequence - 1; }
+
+	// FFastArraySerializer
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, const int32 FinalSize);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
+	{
+		return FastArrayDeltaSerialize<FFlowReplicatedEvent, FFlowReplicatedEventQueue>(Events, DeltaParams, *this);
+	}
+	// --
+
+private:
+	UPROPERTY()
+	TArray<FFlowReplicatedEvent> Events;
+
+	// Not a property, so the component's archetype isn't copied here, set by UFlowComponent::PostInitProperties
+	UFlowComponent* Owner = nullptr;
+
+	// Server-only
+	uint32 NextSequence = 1;
+
+	// Client-only, events up to this one were already applied
+	uint32 LastAppliedSequence = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FFlowReplicatedEventQueue> : public TStructOpsTypeTraitsBase2<FFlowReplicatedEventQueue>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,21 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+using UnrealBuildTool;
+
+public class FlowBenchmark : ModuleRules
+{
+	public FlowBenchmark(ReadOnlyTargetRules target) : base(target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PrivateDependencyModuleNames.AddRange(new[]
+		{
+			"Core",
+			"CoreUObject",
+			"DeveloperSettings",
+			"Engine",
+			"Flow",
+			"GameplayTags"
+		});
+	}
+}
\ No newline at end of file
@@ -0,0 +1,971 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "FlowAsset.h"
+#include "FlowComponent.h"
+#include "FlowLogChannels.h"
+#include "FlowSave.h"
+#include "FlowSettings.h"
+#include "FlowSubsystem.h"
+#include "Nodes/FlowNode.h"
+#include "Nodes/Operators/FlowNode_LogicalAND.h"
+#include "Nodes/Route/FlowNode_ExecutionSequence.h"
+#include "Nodes/Route/FlowNode_Reroute.h"
+#include "Nodes/Route/FlowNode_Start.h"
+#include "Nodes/Route/FlowNode_SubGraph.h"
+#include "Nodes/Route/FlowNode_Timer.h"
+#include "Nodes/World/FlowNode_OnActorRegistered.h"
+
+#include "Algo/Find.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Paths.h"
+#include "NativeGameplayTags.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+
+// Procedural benchmark of the Flow runtime, run by the Flow.Benchmark command
+// Developer module available in every build except Shipping, so Test builds can be measured without the editor
+
+namespace FlowBenchmark
+{
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark, "Flow.Benchmark");
+
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_A, "Flow.Benchmark.A");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_A_0, "Flow.Benchmark.A.0");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_A_1, "Flow.Benchmark.A.1");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_A_2, "Flow.Benchmark.A.2");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_A_3, "Flow.Benchmark.A.3");
+
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_B, "Flow.Benchmark.B");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_B_0, "Flow.Benchmark.B.0");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_B_1, "Flow.Benchmark.B.1");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_B_2, "Flow.Benchmark.B.2");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_B_3, "Flow.Benchmark.B.3");
+
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_C, "Flow.Benchmark.C");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_C_0, "Flow.Benchmark.C.0");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_C_1, "Flow.Benchmark.C.1");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_C_2, "Flow.Benchmark.C.2");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_C_3, "Flow.Benchmark.C.3");
+
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_D, "Flow.Benchmark.D");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_D_0, "Flow.Benchmark.D.0");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_D_1, "Flow.Benchmark.D.1");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_D_2, "Flow.Benchmark.D.2");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_D_3, "Flow.Benchmark.D.3");
+
+	static const FNativeGameplayTag* const LeafTags[] = {
+		&TAG_Benchmark_A_0, &TAG_Benchmark_A_1, &TAG_Benchmark_A_2, &TAG_Benchmark_A_3,
+		&TAG_Benchmark_B_0, &TAG_Benchmark_B_1, &TAG_Benchmark_B_2, &TAG_Benchmark_B_3,
+		&TAG_Benchmark_C_0, &TAG_Benchmark_C_1, &TAG_Benchmark_C_2, &TAG_Benchmark_C_3,
+		&TAG_Benchmark_D_0, &TAG_Benchmark_D_1, &TAG_Benchmark_D_2, &TAG_Benchmark_D_3
+	};
+
+	// Spreads components and observers evenly across the leaf tags
+	static FGameplayTag GetLeafTag(const int32 Index)
+	{
+		return LeafTags[Index % UE_ARRAY_COUNT(LeafTags)]->GetTag();
+	}
+
+	static const TCHAR* const AllSuites[] = {
+		TEXT("Chain"), TEXT("FanOut"), TEXT("Instances"), TEXT("Nesting"), TEXT("Observers"), TEXT("Timers"), TEXT("TagQuery"), TEXT("Save")
+	};
+}
+
+struct FFlowBenchmarkResult
+{
+	FString Suite;
+	FString Case;
+
+	// Size of the generated graph or data set, i.e. number of nodes, components or records
+	int32 Scale;
+
+	// Number of measured operations, i.e. executed inputs or queries
+	int32 Iterations;
+
+	double TotalMs;
+
+	// Size of the produced data, if the case measures it
+	int64 Bytes;
+
+	double GetPerIterationUs() const
+	{
+		return Iterations > 0 ? TotalMs * 1000.0 / Iterations : 0.0;
+	}
+};
+
+/**
+ * Builds Flow Assets procedurally and measures hot paths of the runtime at scale
+ * - graphs exist only in memory, so the benchmark runs in a game world: PIE would harvest connections from the graph editor
+ * - headless run: -game -nullrhi -ExecCmds="Flow.Benchmark, Quit"
+ * - results are written to Saved/FlowBenchmark as CSV and JSON, so runs can be compared between changes
+ * - automation tests run suites at their smallest scale, failing on checks which the benchmark only reports
+ */
+class FFlowBenchmark
+{
+public:
+	FFlowBenchmark(UWorld& InWorld, UFlowSubsystem& InFlowSubsystem, FOutputDevice& InAr, FAutomationTestBase* InTest = nullptr);
+	~FFlowBenchmark();
+
+	void Run(const TArray<FString>& Suites);
+	void WriteReport() const;
+
+private:
+	UWorld& World;
+	UFlowSubsystem& FlowSubsystem;
+	FOutputDevice& Ar;
+
+	// Test running the benchmark, if any
+	FAutomationTestBase* Test;
+
+	TArray<FFlowBenchmarkResult> Results;
+
+	// Templates are transient objects, not referenced by anything until instanced
+	TArray<TStrongObjectPtr<UFlowAsset>> Templates;
+
+	// Distinct owners of Root Flows, spawned on demand
+	TArray<AActor*> Owners;
+
+	// Owner of Flow Components created by the benchmark, these are registered directly in the Flow Subsystem
+	AActor* ComponentsOwner;
+
+	void RunChain();
+	void RunFanOut();
+	void RunInstances();
+	void RunNesting();
+	void RunObservers();
+	void RunTimers();
+	void RunTagQuery();
+	void RunSave();
+
+	void AddResult(const TCHAR* Suite, const FString& Case, const int32 Scale, const int32 Iterations, const double Seconds, const int64 Bytes = 0);
+
+	// Failed check is an error of the running test, otherwise it's only reported
+	void Verify(const bool bCondition, const FString& Message) const;
+
+	// Tests measure only the smallest scale, as these check the results
+	TArray<int32> GetScales(const std::initializer_list<int32> Scales) const
+	{
+		return Test ? TArray<int32>({*Scales.begin()}) : TArray<int32>(Scales);
+	}
+
+//////////////////////////////////////////////////////////////////////////
+// Graph building
+
+	UFlowAsset* NewTemplate(const FString& BaseName);
+
+	template <class T>
+	T* AddNode(UFlowAsset& Template)
+	{
+		T* Node = NewObject<T>(&Template, NAME_None, RF_Transient);
+		Node->SetGuid(FGuid::NewGuid());
+		Template.AddNode_ForTesting(Node);
+		return Node;
+	}
+
+	static void Connect(UFlowNode& From, const FName& OutputPinName, const UFlowNode& To, const FName& InputPinName);
+	static void SetNumberedOutputs(UFlowNode& Node, const int32 OutputsNum);
+
+	// Editable properties of nodes aren't exposed to code, as these are meant to be set in the graph editor
+	template <typename T>
+	static void SetNodeProperty(UFlowNode& Node, const FName& PropertyName, const T& Value)
+	{
+		const FProperty* Property = FindFProperty<FProperty>(Node.GetClass(), PropertyName);
+		check(Property && Property->GetElementSize() == sizeof(T));
+		*Property->ContainerPtrToValuePtr<T>(&Node) = Value;
+	}
+
+	// Start -> Reroute x Length
+	UFlowAsset* BuildChain(const int32 Length, FGuid& OutFirstNodeGuid);
+
+	// Start -> Sequence -> Reroute x Width
+	UFlowAsset* BuildFanOut(const int32 Width, FGuid& OutSequenceGuid);
+
+	// Start -> Sub Graph -> ... -> Start -> Reroute, one template per level
+	UFlowAsset* BuildNesting(const int32 Depth);
+
+	// Start -> Sequence -> On Actor Registered x Num, observing leaf tags
+	UFlowAsset* BuildObservers(const int32 Num);
+
+	// Start -> Sequence -> Timer x Num, completing within 64 ticks of the timer wheel
+	UFlowAsset* BuildTimers(const int32 Num);
+
+	// Start -> Sequence -> Logical AND x Num, each staying active with a name in its SaveGame state
+	UFlowAsset* BuildSaveGraph(const int32 Num);
+
+	// Graph with a Sequence fanning out into Num nodes created by AddTarget
+	UFlowAsset* BuildSequence(const FString& BaseName, const int32 Num, TFunctionRef<UFlowNode*(UFlowAsset&, int32)> AddTarget, const FName& TargetInputPinName, FGuid* OutSequenceGuid = nullptr);
+
+//////////////////////////////////////////////////////////////////////////
+// World state
+
+	AActor* GetOwner(const int32 Index);
+	void FinishRootFlows(const int32 OwnersNum);
+
+	void CreateComponents(const int32 Num, TArray<UFlowComponent*>& OutComponents) const;
+	void UnregisterComponents(const TArray<UFlowComponent*>& Components) const;
+};
+
+FFlowBenchmark::FFlowBenchmark(UWorld& InWorld, UFlowSubsystem& InFlowSubsystem, FOutputDevice& InAr, FAutomationTestBase* InTest)
+	: World(InWorld)
+	, FlowSubsystem(InFlowSubsystem)
+	, Ar(InAr)
+	, Test(InTest)
+	, ComponentsOwner(InWorld.SpawnActor<AActor>())
+{
+}
+
+FFlowBenchmark::~FFlowBenchmark()
+{
+	for (AActor* Owner : Owners)
+	{
+		FlowSubsystem.FinishAllRootFlows(Owner, EFlowFinishPolicy::Abort);
+		Owner->Destroy();
+	}
+
+	if (ComponentsOwner)
+	{
+		ComponentsOwner->Destroy();
+	}
+}
+
+void FFlowBenchmark::Run(const TArray<FString>& Suites)
+{
+	// signals have to be delivered synchronously, unless a case enables the queue explicitly
+	UFlowSettings* Settings = UFlowSettings::Get();
+	TGuardValue<bool> QueuedExecutionGuard(Settings->bQueuedExecution, false);
+	TGuardValue<int32> MaxQueuedSignalsGuard(Settings->MaxQueuedSignalsPerFrame, 0);
+	TGuardValue<float> QueuedSignalsBudgetGuard(Settings->QueuedSignalsTimeBudget, 0.0f);
+
+	// logging nodes without connected outputs would dominate the measured time
+	TGuardValue<bool> LogOnSignalDisabledGuard(Settings->bLogOnSignalDisabled, false);
+	TGuardValue<bool> LogOnSignalPassthroughGuard(Settings->bLogOnSignalPassthrough, false);
+
+	const auto ShouldRun = [&Suites](const TCHAR* Suite)
+	{
+		return Suites.Num() == 0 || Suites.ContainsByPredicate([Suite](const FString& Name) { return Name.Equals(Suite, ESearchCase::IgnoreCase); });
+	};
+
+	Ar.Logf(TEXT("%-10s %-22s %8s %10s %12s %14s %12s"), TEXT("Suite"), TEXT("Case"), TEXT("Scale"), TEXT("Iterations"), TEXT("Total ms"), TEXT("Per iter us"), TEXT("Bytes"));
+
+	if (ShouldRun(TEXT("Chain")))
+	{
+		RunChain();
+	}
+	if (ShouldRun(TEXT("FanOut")))
+	{
+		RunFanOut();
+	}
+	if (ShouldRun(TEXT("Instances")))
+	{
+		RunInstances();
+	}
+	if (ShouldRun(TEXT("Nesting")))
+	{
+		RunNesting();
+	}
+	if (ShouldRun(TEXT("Observers")))
+	{
+		RunObservers();
+	}
+	if (ShouldRun(TEXT("Timers")))
+	{
+		RunTimers();
+	}
+	if (ShouldRun(TEXT("TagQuery")))
+	{
+		RunTagQuery();
+	}
+	if (ShouldRun(TEXT("Save")))
+	{
+		RunSave();
+	}
+}
+
+void FFlowBenchmark::AddResult(const TCHAR* Suite, const FString& Case, const int32 Scale, const int32 Iterations, const double Seconds, const int64 Bytes)
+{
+	const FFlowBenchmarkResult& Result = Results.Add_GetRef({Suite, Case, Scale, Iterations, Seconds * 1000.0, Bytes});
+	Ar.Logf(TEXT("%-10s %-22s %8d %10d %12.3f %14.3f %12lld"), *Result.Suite, *Result.Case, Result.Scale, Result.Iterations, Result.TotalMs, Result.GetPerIterationUs(), Result.Bytes);
+}
+
+void FFlowBenchmark::Verify(const bool bCondition, const FString& Message) const
+{
+	if (bCondition)
+	{
+		return;
+	}
+
+	if (Test)
+	{
+		Test->AddError(Message);
+	}
+	else
+	{
+		UE_LOG(LogFlow, Warning, TEXT("Flow.Benchmark: %s"), *Message);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Suites
+
+void FFlowBenchmark::RunChain()
+{
+	// synchronous execution recurses through the whole chain, so its length is limited by the stack
+	for (const int32 Length : {50, 200, 500})
+	{
+		FGuid FirstNodeGuid;
+		UFlowAsset* Template = BuildChain(Length, FirstNodeGuid);
+
+		for (const bool bQueued : {false, true})
+		{
+			TGuardValue<bool> QueuedExecutionGuard(UFlowSettings::Get()->bQueuedExecution, bQueued);
+
+			UFlowAsset* Instance = FlowSubsystem.CreateRootFlow(GetOwner(0), Template);
+			Instance->StartFlow();
+
+			UFlowNode* FirstNode = Instance->GetNode(FirstNodeGuid);
+			const int32 Iterations = FMath::Max(1, 100000 / Length);
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Iterations; i++)
+			{
+				Instance->TriggerInput_ForTesting(FirstNode, 0);
+			}
+			AddResult(TEXT("Chain"), bQueued ? TEXT("TriggerInput/Queued") : TEXT("TriggerInput"), Length, Iterations * Length, FPlatformTime::Seconds() - StartTime);
+
+			FlowSubsystem.FinishRootFlow(GetOwner(0), Template, EFlowFinishPolicy::Abort);
+		}
+	}
+}
+
+void FFlowBenchmark::RunFanOut()
+{
+	for (const int32 Width : {100, 1000, 10000})
+	{
+		FGuid SequenceGuid;
+		UFlowAsset* Template = BuildFanOut(Width, SequenceGuid);
+
+		UFlowAsset* Instance = FlowSubsystem.CreateRootFlow(GetOwner(0), Template);
+		Instance->StartFlow();
+
+		UFlowNode* Sequence = Instance->GetNode(SequenceGuid);
+		const int32 Iterations = FMath::Max(1, 200000 / Width);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			Instance->TriggerInput_ForTesting(Sequence, 0);
+		}
+		AddResult(TEXT("FanOut"), TEXT("TriggerInput"), Width, Iterations * (Width + 1), FPlatformTime::Seconds() - StartTime);
+
+		FlowSubsystem.FinishRootFlow(GetOwner(0), Template, EFlowFinishPolicy::Abort);
+	}
+}
+
+void FFlowBenchmark::RunInstances()
+{
+	for (const int32 Size : {10, 100, 1000})
+	{
+		FGuid FirstNodeGuid;
+		UFlowAsset* Template = BuildChain(Size, FirstNodeGuid);
+
+		for (const bool bPooled : {false, true})
+		{
+			TGuardValue<bool> PoolInstancesGuard(Template->bPoolInstances, bPooled);
+
+			for (const bool bLazy : {false, true})
+			{
+				TGuardValue<bool> LazyNodeInstancingGuard(Template->bLazyNodeInstancing, bLazy);
+
+				const int32 Iterations = FMath::Max(10, 20000 / Size);
+				double CreateSeconds = 0.0;
+				double FinishSeconds = 0.0;
+
+				for (int32 i = 0; i < Iterations; i++)
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					FlowSubsystem.CreateRootFlow(GetOwner(0), Template);
+					const double CreatedTime = FPlatformTime::Seconds();
+					FlowSubsystem.FinishRootFlow(GetOwner(0), Template, EFlowFinishPolicy::Keep);
+
+					CreateSeconds += CreatedTime - StartTime;
+					FinishSeconds += FPlatformTime::Seconds() - CreatedTime;
+				}
+
+				const FString Variant = FString(bPooled ? TEXT("/Pooled") : TEXT("")) + (bLazy ? TEXT("/Lazy") : TEXT(""));
+				AddResult(TEXT("Instances"), TEXT("Create") + Variant, Size, Iterations, CreateSeconds);
+				AddResult(TEXT("Instances"), TEXT("Finish") + Variant, Size, Iterations, FinishSeconds);
+
+				// pooled instances keep their node instances, so the next case has to start with the empty pool
+				FlowSubsystem.RemoveInstancePool_ForTesting(Template);
+			}
+		}
+	}
+}
+
+void FFlowBenchmark::RunNesting()
+{
+	for (const int32 Depth : GetScales({4, 16, 64}))
+	{
+		UFlowAsset* Template = BuildNesting(Depth);
+
+		const int32 Iterations = FMath::Max(10, 2000 / Depth);
+		double StartSeconds = 0.0;
+		double FinishSeconds = 0.0;
+
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FlowSubsystem.StartRootFlow(GetOwner(0), Template);
+			const double StartedTime = FPlatformTime::Seconds();
+
+			if (i == 0)
+			{
+				Verify(FlowSubsystem.GetInstancedSubFlows().Num() == Depth - 1,
+				       FString::Printf(TEXT("expected %d Sub Flows, %d were created"), Depth - 1, FlowSubsystem.GetInstancedSubFlows().Num()));
+			}
+
+			FlowSubsystem.FinishRootFlow(GetOwner(0), Template, EFlowFinishPolicy::Keep);
+
+			if (i == 0)
+			{
+				Verify(FlowSubsystem.GetInstancedSubFlows().Num() == 0,
+				       FString::Printf(TEXT("%d Sub Flows left after finishing the Root Flow"), FlowSubsystem.GetInstancedSubFlows().Num()));
+			}
+
+			StartSeconds += StartedTime - StartTime;
+			FinishSeconds += FPlatformTime::Seconds() - StartedTime;
+		}
+
+		AddResult(TEXT("Nesting"), TEXT("StartRootFlow"), Depth, Iterations, StartSeconds);
+		AddResult(TEXT("Nesting"), TEXT("FinishRootFlow"), Depth, Iterations, FinishSeconds);
+	}
+}
+
+void FFlowBenchmark::RunObservers()
+{
+	constexpr int32 ComponentsNum = 1000;
+
+	TArray<UFlowComponent*> Components;
+	CreateComponents(ComponentsNum, Components);
+
+	for (const int32 ObserversNum : {1000, 5000})
+	{
+		UFlowAsset* Template = BuildObservers(ObserversNum);
+
+		const double StartTime = FPlatformTime::Seconds();
+		FlowSubsystem.StartRootFlow(GetOwner(0), Template);
+		AddResult(TEXT("Observers"), TEXT("Subscribe"), ObserversNum, ObserversNum, FPlatformTime::Seconds() - StartTime);
+
+		// every component notifies observers of its leaf tag, both on registration and unregistration
+		const double RegisterTime = FPlatformTime::Seconds();
+		for (UFlowComponent* Component : Components)
+		{
+			FlowSubsystem.RegisterComponent_ForTesting(Component);
+		}
+		for (UFlowComponent* Component : Components)
+		{
+			FlowSubsystem.UnregisterComponent_ForTesting(Component);
+		}
+		AddResult(TEXT("Observers"), TEXT("Register+Unregister"), ObserversNum, ComponentsNum, FPlatformTime::Seconds() - RegisterTime);
+
+		FlowSubsystem.FinishRootFlow(GetOwner(0), Template, EFlowFinishPolicy::Abort);
+	}
+}
+
+void FFlowBenchmark::RunTimers()
+{
+	// timers are advanced by ticking the wheel directly, without waiting for the world time
+	constexpr int32 MaxTicks = 1000;
+
+	for (const int32 TimersNum : {1000, 10000})
+	{
+		UFlowAsset* Template = BuildTimers(TimersNum);
+
+		const double StartTime = FPlatformTime::Seconds();
+		FlowSubsystem.StartRootFlow(GetOwner(0), Template);
+		AddResult(TEXT("Timers"), TEXT("Schedule"), TimersNum, TimersNum, FPlatformTime::Seconds() - StartTime);
+
+		int32 Ticks = 0;
+		const double TickTime = FPlatformTime::Seconds();
+		while (FlowSubsystem.GetFlowTimersNum() > 0 && Ticks < MaxTicks)
+		{
+			FlowSubsystem.TickTimerWheel_ForTesting();
+			Ticks++;
+		}
+		AddResult(TEXT("Timers"), TEXT("TickUntilCompleted"), TimersNum, Ticks, FPlatformTime::Seconds() - TickTime);
+
+		FlowSubsystem.FinishRootFlow(GetOwner(0), Template, EFlowFinishPolicy::Abort);
+	}
+}
+
+void FFlowBenchmark::RunTagQuery()
+{
+	constexpr int32 Queries = 200;
+
+	const FGameplayTag GroupTag = FlowBenchmark::TAG_Benchmark_B.GetTag();
+	const FGameplayTag LeafTag = FlowBenchmark::TAG_Benchmark_C_2.GetTag();
+
+	for (const int32 ComponentsNum : GetScales({1000, 10000, 50000}))
+	{
+		TArray<UFlowComponent*> Components;
+		CreateComponents(ComponentsNum, Components);
+
+		const double RegisterTime = FPlatformTime::Seconds();
+		for (UFlowComponent* Component : Components)
+		{
+			FlowSubsystem.RegisterComponent_ForTesting(Component);
+		}
+		AddResult(TEXT("TagQuery"), TEXT("Register"), ComponentsNum, ComponentsNum, FPlatformTime::Seconds() - RegisterTime);
+
+		for (const FGameplayTag& Tag : {GroupTag, LeafTag})
+		{
+			const FString TagCase = Tag == GroupTag ? TEXT("ParentTag") : TEXT("LeafTag");
+
+			// non-exact query as it worked before the tag index: every registered component is matched against the tag
+			int32 ScannedNum = 0;
+			const double ScanTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Queries; i++)
+			{
+				TArray<TWeakObjectPtr<UFlowComponent>> FoundComponents;
+				for (UFlowComponent* Component : Components)
+				{
+					if (Component->IdentityTags.HasTag(Tag))
+					{
+						FoundComponents.Emplace(Component);
+					}
+				}
+				ScannedNum = FoundComponents.Num();
+			}
+			AddResult(TEXT("TagQuery"), TagCase + TEXT("/Scan"), ComponentsNum, Queries, FPlatformTime::Seconds() - ScanTime);
+
+			int32 IndexedNum = 0;
+			const double IndexTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < Queries; i++)
+			{
+				const TSet<UFlowComponent*> FoundComponents = FlowSubsystem.GetFlowComponentsByTag(Tag, UFlowComponent::StaticClass(), false);
+				IndexedNum = FoundComponents.Num();
+			}
+			AddResult(TEXT("TagQuery"), TagCase + TEXT("/Index"), ComponentsNum, Queries, FPlatformTime::Seconds() - IndexTime);
+
+			Verify(ScannedNum == IndexedNum, FString::Printf(TEXT("tag index returned %d components for %s, registry scan returned %d"), IndexedNum, *Tag.ToString(), ScannedNum));
+		}
+
+		const double UnregisterTime = FPlatformTime::Seconds();
+		UnregisterComponents(Components);
+		AddResult(TEXT("TagQuery"), TEXT("Unregister"), ComponentsNum, ComponentsNum, FPlatformTime::Seconds() - UnregisterTime);
+	}
+}
+
+void FFlowBenchmark::RunSave()
+{
+	constexpr int32 NodesPerInstance = 16;
+	constexpr int32 SaveRepeats = 3;
+
+	UFlowSettings* Settings = UFlowSettings::Get();
+	UFlowAsset* Template = BuildSaveGraph(NodesPerInstance);
+
+	for (const int32 RecordsNum : GetScales({100, 1000, 5000}))
+	{
+		for (int32 i = 0; i < RecordsNum; i++)
+		{
+			FlowSubsystem.StartRootFlow(GetOwner(i), Template);
+		}
+
+		// saves of both encodings are kept for the load
+		UFlowSaveGame* SaveGames[2] = {nullptr, nullptr};
+
+		for (const bool bNameTables : {false, true})
+		{
+			TArray<uint8> SerialBytes;
+
+			for (const bool bParallel : {false, true})
+			{
+				TGuardValue<bool> ParallelGuard(Settings->bParallelSaveCompression, bParallel);
+				TGuardValue<bool> NameTablesGuard(Settings->bSaveNameTables, bNameTables);
+
+				// name tables are only appended, so every save starts with an empty SaveGame
+				UFlowSaveGame* SaveGame = nullptr;
+				double SaveSeconds = 0.0;
+				for (int32 Repeat = 0; Repeat < SaveRepeats; Repeat++)
+				{
+					SaveGame = NewObject<UFlowSaveGame>(GetTransientPackage());
+
+					const double StartTime = FPlatformTime::Seconds();
+					FlowSubsystem.OnGameSaved(SaveGame);
+					SaveSeconds += FPlatformTime::Seconds() - StartTime;
+				}
+
+				TArray<uint8> SaveBytes;
+				UGameplayStatics::SaveGameToMemory(SaveGame, SaveBytes);
+
+				const FString SaveCase = FString(TEXT("OnGameSaved/")) + (bParallel ? TEXT("Parallel") : TEXT("Serial")) + (bNameTables ? TEXT("/NameTables") : TEXT("/Strings"));
+				AddResult(TEXT("Save"), SaveCase, RecordsNum, SaveRepeats, SaveSeconds, SaveBytes.Num());
+
+				// parallel compression has to produce exactly the same data
+				if (!bParallel)
+				{
+					SerialBytes = MoveTemp(SaveBytes);
+				}
+				else
+				{
+					Verify(SaveBytes == SerialBytes, FString::Printf(TEXT("parallel save of %d records differs from the serial save"), RecordsNum));
+				}
+
+				SaveGames[bNameTables ? 1 : 0] = SaveGame;
+			}
+		}
+
+		FinishRootFlows(RecordsNum);
+
+		// LoadRootFlow allows only a single instance of the template, so its steps are repeated for every saved instance
+		// OnGameLoaded() isn't called, as projects apply loaded data to their own systems there
+		const FString WorldName = Template->IsBoundToWorld() ? World.GetName() : FString();
+		UFlowSaveGame* PreviousLoadedSaveGame = FlowSubsystem.GetLoadedSaveGame();
+
+		for (const bool bNameTables : {false, true})
+		{
+			UFlowSaveGame* SaveGame = SaveGames[bNameTables ? 1 : 0];
+			FlowSubsystem.SetLoadedSaveGame_ForTesting(SaveGame);
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < SaveGame->FlowInstances.Num(); i++)
+			{
+				if (const FFlowAssetSaveData* AssetRecord = SaveGame->FindFlowInstance(WorldName, SaveGame->FlowInstances[i].InstanceName))
+				{
+					if (UFlowAsset* LoadedInstance = FlowSubsystem.CreateRootFlow(GetOwner(i), Template))
+					{
+						LoadedInstance->LoadInstance(*AssetRecord);
+					}
+				}
+			}
+			AddResult(TEXT("Save"), bNameTables ? TEXT("LoadRootFlow/NameTables") : TEXT("LoadRootFlow/Strings"), RecordsNum, SaveGame->FlowInstances.Num(), FPlatformTime::Seconds() - StartTime);
+
+			FinishRootFlows(RecordsNum);
+		}
+
+		FlowSubsystem.SetLoadedSaveGame_ForTesting(PreviousLoadedSaveGame);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Graph building
+
+UFlowAsset* FFlowBenchmark::NewTemplate(const FString& BaseName)
+{
+	UPackage* Package = GetTransientPackage();
+	const FName TemplateName = MakeUniqueObjectName(Package, UFlowAsset::StaticClass(), *FString::Printf(TEXT("FlowBenchmark_%s"), *BaseName));
+
+	UFlowAsset* Template = NewObject<UFlowAsset>(Package, TemplateName, RF_Transient);
+	Templates.Emplace(Template);
+	return Template;
+}
+
+void FFlowBenchmark::Connect(UFlowNode& From, const FName& OutputPinName, const UFlowNode& To, const FName& InputPinName)
+{
+	From.AddConnection_ForTesting(OutputPinName, FConnectedPin(To.GetGuid(), InputPinName));
+}
+
+void FFlowBenchmark::SetNumberedOutputs(UFlowNode& Node, const int32 OutputsNum)
+{
+	TArray<FFlowPin> OutputPins;
+	OutputPins.Reserve(OutputsNum);
+	for (int32 i = 0; i < OutputsNum; i++)
+	{
+		OutputPins.Emplace(FName(*FString::FromInt(i)));
+	}
+	Node.SetOutputPins_ForTesting(OutputPins);
+}
+
+UFlowAsset* FFlowBenchmark::BuildChain(const int32 Length, FGuid& OutFirstNodeGuid)
+{
+	UFlowAsset* Template = NewTemplate(FString::Printf(TEXT("Chain%d"), Length));
+
+	UFlowNode* PreviousNode = AddNode<UFlowNode_Start>(*Template);
+	for (int32 i = 0; i < Length; i++)
+	{
+		// chain doesn't end with the Finish node, as it would finish the Root Flow
+		UFlowNode* Node = AddNode<UFlowNode_Reroute>(*Template);
+		Connect(*PreviousNode, UFlowNode::DefaultOutputPin.PinName, *Node, UFlowNode::DefaultInputPin.PinName);
+
+		if (i == 0)
+		{
+			OutFirstNodeGuid = Node->GetGuid();
+		}
+		PreviousNode = Node;
+	}
+
+	return Template;
+}
+
+UFlowAsset* FFlowBenchmark::BuildSequence(const FString& BaseName, const int32 Num, TFunctionRef<UFlowNode*(UFlowAsset&, int32)> AddTarget, const FName& TargetInputPinName, FGuid* OutSequenceGuid)
+{
+	UFlowAsset* Template = NewTemplate(FString::Printf(TEXT("%s%d"), *BaseName, Num));
+
+	UFlowNode* Start = AddNode<UFlowNode_Start>(*Template);
+	UFlowNode* Sequence = AddNode<UFlowNode_ExecutionSequence>(*Template);
+	Connect(*Start, UFlowNode::DefaultOutputPin.PinName, *Sequence, UFlowNode::DefaultInputPin.PinName);
+
+	// measuring routing of signals, not the bookkeeping of executed connections
+	SetNodeProperty<bool>(*Sequence, TEXT("bSavePinExecutionState"), false);
+	SetNumberedOutputs(*Sequence, Num);
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		const UFlowNode* Target = AddTarget(*Template, i);
+		Connect(*Sequence, FName(*FString::FromInt(i)), *Target, TargetInputPinName);
+	}
+
+	if (OutSequenceGuid)
+	{
+		*OutSequenceGuid = Sequence->GetGuid();
+	}
+
+	return Template;
+}
+
+UFlowAsset* FFlowBenchmark::BuildFanOut(const int32 Width, FGuid& OutSequenceGuid)
+{
+	return BuildSequence(TEXT("FanOut"), Width, [this](UFlowAsset& Template, int32)
+	{
+		return AddNode<UFlowNode_Reroute>(Template);
+	}, UFlowNode::DefaultInputPin.PinName, &OutSequenceGuid);
+}
+
+UFlowAsset* FFlowBenchmark::BuildNesting(const int32 Depth)
+{
+	UFlowAsset* Template = NewTemplate(FString::Printf(TEXT("Nesting%d_Level%d"), Depth, Depth - 1));
+	{
+		UFlowNode* Start = AddNode<UFlowNode_Start>(*Template);
+		UFlowNode* Reroute = AddNode<UFlowNode_Reroute>(*Template);
+		Connect(*Start, UFlowNode::DefaultOutputPin.PinName, *Reroute, UFlowNode::DefaultInputPin.PinName);
+	}
+
+	for (int32 Level = Depth - 2; Level >= 0; Level--)
+	{
+		UFlowAsset* ParentTemplate = NewTemplate(FString::Printf(TEXT("Nesting%d_Level%d"), Depth, Level));
+
+		UFlowNode* Start = AddNode<UFlowNode_Start>(*ParentTemplate);
+		UFlowNode* SubGraph = AddNode<UFlowNode_SubGraph>(*ParentTemplate);
+		SetNodeProperty<TSoftObjectPtr<UFlowAsset>>(*SubGraph, TEXT("Asset"), TSoftObjectPtr<UFlowAsset>(Template));
+		Connect(*Start, UFlowNode::DefaultOutputPin.PinName, *SubGraph, TEXT("Start"));
+
+		Template = ParentTemplate;
+	}
+
+	return Template;
+}
+
+UFlowAsset* FFlowBenchmark::BuildObservers(const int32 Num)
+{
+	return BuildSequence(TEXT("Observers"), Num, [this](UFlowAsset& Template, const int32 Index)
+	{
+		UFlowNode* Observer = AddNode<UFlowNode_OnActorRegistered>(Template);
+		SetNodeProperty<FGameplayTagContainer>(*Observer, TEXT("IdentityTags"), FGameplayTagContainer(FlowBenchmark::GetLeafTag(Index)));
+
+		// observer keeps receiving events until the flow is finished
+		SetNodeProperty<int32>(*Observer, TEXT("SuccessLimit"), 0);
+		return Observer;
+	}, TEXT("Start"));
+}
+
+UFlowAsset* FFlowBenchmark::BuildTimers(const int32 Num)
+{
+	const float Resolution = UFlowSettings::Get()->FlowTimerResolution;
+
+	return BuildSequence(TEXT("Timers"), Num, [this, Resolution](UFlowAsset& Template, const int32 Index)
+	{
+		UFlowNode* Timer = AddNode<UFlowNode_Timer>(Template);
+		SetNodeProperty<float>(*Timer, TEXT("CompletionTime"), Resolution * (1 + Index % 64));
+		return Timer;
+	}, UFlowNode::DefaultInputPin.PinName);
+}
+
+UFlowAsset* FFlowBenchmark::BuildSaveGraph(const int32 Num)
+{
+	// triggering only the first input keeps the node active
+	return BuildSequence(TEXT("Save"), Num, [this](UFlowAsset& Template, int32)
+	{
+		return AddNode<UFlowNode_LogicalAND>(Template);
+	}, TEXT("0"));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// World state
+
+AActor* FFlowBenchmark::GetOwner(const int32 Index)
+{
+	while (Owners.Num() <= Index)
+	{
+		Owners.Add(World.SpawnActor<AActor>());
+	}
+
+	return Owners[Index];
+}
+
+void FFlowBenchmark::FinishRootFlows(const int32 OwnersNum)
+{
+	for (int32 i = 0; i < OwnersNum && i < Owners.Num(); i++)
+	{
+		FlowSubsystem.FinishAllRootFlows(Owners[i], EFlowFinishPolicy::Abort);
+	}
+}
+
+void FFlowBenchmark::CreateComponents(const int32 Num, TArray<UFlowComponent*>& OutComponents) const
+{
+	OutComponents.Reserve(Num);
+	for (int32 i = 0; i < Num; i++)
+	{
+		UFlowComponent* Component = NewObject<UFlowComponent>(ComponentsOwner, NAME_None, RF_Transient);
+		Component->IdentityTags.AddTag(FlowBenchmark::GetLeafTag(i));
+		OutComponents.Add(Component);
+	}
+}
+
+void FFlowBenchmark::UnregisterComponents(const TArray<UFlowComponent*>& Components) const
+{
+	for (UFlowComponent* Component : Components)
+	{
+		FlowSubsystem.UnregisterComponent_ForTesting(Component);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Report
+
+void FFlowBenchmark::WriteReport() const
+{
+	const FString Timestamp = FDateTime::Now().ToString();
+	const FString BasePath = FPaths::ProjectSavedDir() / TEXT("FlowBenchmark") / FString::Printf(TEXT("FlowBenchmark-%s"), *Timestamp);
+
+	FString Csv = TEXT("Suite,Case,Scale,Iterations,TotalMs,PerIterationUs,Bytes\n");
+	for (const FFlowBenchmarkResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%s,%d,%d,%.4f,%.4f,%lld\n"), *Result.Suite, *Result.Case, Result.Scale, Result.Iterations, Result.TotalMs, Result.GetPerIterationUs(), Result.Bytes);
+	}
+
+	FString Json = FString::Printf(TEXT("{\n\t\"timestamp\": \"%s\",\n\t\"configuration\": \"%s\",\n\t\"results\": ["), *Timestamp, LexToString(FApp::GetBuildConfiguration()));
+	for (int32 i = 0; i < Results.Num(); i++)
+	{
+		const FFlowBenchmarkResult& Result = Results[i];
+		Json += FString::Printf(TEXT("%s\n\t\t{\"suite\": \"%s\", \"case\": \"%s\", \"scale\": %d, \"iterations\": %d, \"totalMs\": %.4f, \"perIterationUs\": %.4f, \"bytes\": %lld}"),
+		                        i > 0 ? TEXT(",") : TEXT(""), *Result.Suite, *Result.Case, Result.Scale, Result.Iterations, Result.TotalMs, Result.GetPerIterationUs(), Result.Bytes);
+	}
+	Json += TEXT("\n\t]\n}\n");
+
+	FFileHelper::SaveStringToFile(Csv, *(BasePath + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(Json, *(BasePath + TEXT(".json")));
+
+	Ar.Logf(TEXT("Flow.Benchmark: report written to %s.csv"), *FPaths::ConvertRelativePathToFull(BasePath));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Command
+
+namespace FlowBenchmark
+{
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice BenchmarkCommand(
+		TEXT("Flow.Benchmark"),
+		TEXT("Measures the Flow runtime on procedurally built graphs and writes the report to Saved/FlowBenchmark. Optional arguments: suites to run, all by default (Chain, FanOut, Instances, Nesting, Observers, Timers, TagQuery, Save)"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+			UFlowSubsystem* FlowSubsystem = GameInstance ? GameInstance->GetSubsystem<UFlowSubsystem>() : nullptr;
+			if (FlowSubsystem == nullptr)
+			{
+				Ar.Log(TEXT("Flow.Benchmark requires a game world with the Flow Subsystem"));
+				return;
+			}
+
+#if WITH_EDITOR
+			if (World->WorldType != EWorldType::Game)
+			{
+				Ar.Log(TEXT("Flow.Benchmark requires a standalone game, i.e. -game -nullrhi"));
+				return;
+			}
+#endif
+
+			for (const FString& Suite : Args)
+			{
+				if (!Algo::FindByPredicate(AllSuites, [&Suite](const TCHAR* Name) { return Suite.Equals(Name, ESearchCase::IgnoreCase); }))
+				{
+					Ar.Logf(TEXT("Flow.Benchmark: unknown suite %s"), *Suite);
+					return;
+				}
+			}
+
+			FFlowBenchmark Benchmark(*World, *FlowSubsystem, Ar);
+			Benchmark.Run(Args);
+			Benchmark.WriteReport();
+		}));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Tests
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlowBenchmark
+{
+	// Runs the suite in the standalone game instance, so the test doesn't depend on the loaded map or PIE
+	static bool RunSuiteTest(FAutomationTestBase& Test, const TCHAR* Suite)
+	{
+		const TStrongObjectPtr<UGameInstance> GameInstance(NewObject<UGameInstance>(GEngine));
+		GameInstance->InitializeStandalone();
+
+		UWorld* World = GameInstance->GetWorld();
+		if (UFlowSubsystem* FlowSubsystem = GameInstance->GetSubsystem<UFlowSubsystem>())
+		{
+			FFlowBenchmark Benchmark(*World, *FlowSubsystem, *GLog, &Test);
+			Benchmark.Run({FString(Suite)});
+		}
+		else
+		{
+			Test.AddError(TEXT("Flow Subsystem wasn't created for the standalone game instance"));
+		}
+
+		GameInstance->Shutdown();
+		World->DestroyWorld(false);
+		GEngine->DestroyWorldContext(World);
+
+		return !Test.HasAnyErrors();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlowBenchmarkSaveTest, "Flow.Benchmark.Save", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFlowBenchmarkSaveTest::RunTest(const FString& Parameters)
+{
+	// parallel save compression is active only with compressed records, compared against the serial save
+	UFlowSettings* Settings = UFlowSettings::Get();
+	TGuardValue<bool> CompressSaveDataGuard(Settings->bCompressSaveData, true);
+	TGuardValue<int32> MinCompressedRecordSizeGuard(Settings->MinCompressedRecordSize, 0);
+	TGuardValue<int32> MinParallelSaveRecordsGuard(Settings->MinParallelSaveRecords, 1);
+
+	return FlowBenchmark::RunSuiteTest(*this, TEXT("Save"));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlowBenchmarkNestingTest, "Flow.Benchmark.Nesting", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFlowBenchmarkNestingTest::RunTest(const FString& Parameters)
+{
+	return FlowBenchmark::RunSuiteTest(*this, TEXT("Nesting"));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlowBenchmarkTagQueryTest, "Flow.Benchmark.TagQuery", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFlowBenchmarkTagQueryTest::RunTest(const FString& Parameters)
+{
+	return FlowBenchmark::RunSuiteTest(*this, TEXT("TagQuery"));
+}
+
+#endif
@@ -0,0 +1,6 @@
+// Copyright https://github.com/MothCocoon/FlowGraph/graphs/contributors
+
+#include "Modules/ModuleManager.h"
+
+// Benchmark and automation tests of the Flow runtime, these register themselves on module load
+IMPLEMENT_MODULE(FDefaultModuleImpl, FlowBenchmark)
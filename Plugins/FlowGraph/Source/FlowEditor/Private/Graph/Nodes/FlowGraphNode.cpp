@@ -58,9 +58,9 @@ UFlowNodeBase* UFlowGraphNode::GetFlowNodeBase() const
 	{
 		if (UFlowNode* FlowNode = Cast<UFlowNode>(NodeInstance))
 		{
-			if (const UFlowAsset* InspectedInstance = FlowNode->GetFlowAsset()->GetInspectedInstance())
+			if (UFlowAsset* InspectedInstance = FlowNode->GetFlowAsset()->GetInspectedInstance())
 			{
-				return InspectedInstance->GetNode(FlowNode->GetGuid());
+				return InspectedInstance->GetNodeInstance(FlowNode->GetGuid());
 			}
 		}
 
@@ -1011,7 +1011,7 @@ void UFlowGraphNode::GetPinHoverText(const UEdGraphPin& Pin, FString& HoverTextO
 				for (int32 i = 0; i < PinRecords.Num(); i++)
 				{
 					HoverTextOut.Append(LINE_TERMINATOR);
-					HoverTextOut.Appendf(TEXT("%d) %s"), i + 1, *PinRecords[i].HumanReadableTime);
+					HoverTextOut.Appendf(TEXT("%d) %s"), i + 1, *PinRecords[i].GetHumanReadableTime());
 
 					switch (PinRecords[i].ActivationType)
 					{